@@ -0,0 +1,173 @@
+#pragma once
+//
+// Conversion between calendar dates and linear time
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "hal-common/DateTime.hpp"
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// Fast conversions between calendar dates and days or seconds since 1970-01-01.
+///
+/// The algorithms are the well known "days from civil" conversions, which work
+/// without any loops or tables. All times are treated as UTC without leap seconds.
+/// The day of the week uses the same convention as `DateTime::getDayOfWeek()`,
+/// `0` for monday, up to `6` for sunday.
+///
+namespace CivilTime {
+
+
+/// The number of seconds per day.
+///
+constexpr const uint32_t cSecondsPerDay = 86400;
+
+
+/// The calendar fields of a time.
+///
+struct Fields {
+    uint16_t year; ///< The year, e.g. 2019.
+    uint8_t month; ///< The month 1-12.
+    uint8_t day; ///< The day of the month 1-31.
+    uint8_t hour; ///< The hour 0-23.
+    uint8_t minute; ///< The minute 0-59.
+    uint8_t second; ///< The second 0-59.
+    uint8_t dayOfWeek; ///< The day of the week 0-6.
+};
+
+
+/// Get the number of days since 1970-01-01 for a date.
+///
+/// @param year The year.
+/// @param month The month 1-12.
+/// @param day The day of the month 1-31.
+/// @return The number of days since 1970-01-01.
+///
+constexpr inline int32_t daysFromCivil(int32_t year, uint8_t month, uint8_t day)
+{
+    const int32_t y = year - (month <= 2 ? 1 : 0);
+    const int32_t era = (y >= 0 ? y : y - 399) / 400;
+    const uint32_t yearOfEra = static_cast<uint32_t>(y - era * 400);
+    const uint32_t dayOfYear = (153u * (month > 2 ? month - 3u : month + 9u) + 2u) / 5u + day - 1u;
+    const uint32_t dayOfEra = yearOfEra * 365u + yearOfEra / 4u - yearOfEra / 100u + dayOfYear;
+    return era * 146097 + static_cast<int32_t>(dayOfEra) - 719468;
+}
+
+
+/// Get the day of the week for a number of days since 1970-01-01.
+///
+constexpr inline uint8_t dayOfWeekFromDays(int32_t days)
+{
+    // 1970-01-01 was a thursday.
+    return static_cast<uint8_t>((days % 7 + 10) % 7);
+}
+
+
+/// Convert a number of days since 1970-01-01 into a date.
+///
+/// @param days The number of days since 1970-01-01.
+/// @param fields The fields where year, month, day and day of the week are stored.
+///
+inline void civilFromDays(int32_t days, Fields &fields)
+{
+    const int32_t z = days + 719468;
+    const int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const uint32_t dayOfEra = static_cast<uint32_t>(z - era * 146097);
+    const uint32_t yearOfEra = (dayOfEra - dayOfEra / 1460u + dayOfEra / 36524u - dayOfEra / 146096u) / 365u;
+    const uint32_t dayOfYear = dayOfEra - (365u * yearOfEra + yearOfEra / 4u - yearOfEra / 100u);
+    const uint32_t mp = (5u * dayOfYear + 2u) / 153u;
+    const uint8_t month = static_cast<uint8_t>(mp < 10u ? mp + 3u : mp - 9u);
+    fields.year = static_cast<uint16_t>(static_cast<int32_t>(yearOfEra) + era * 400 + (month <= 2 ? 1 : 0));
+    fields.month = month;
+    fields.day = static_cast<uint8_t>(dayOfYear - (153u * mp + 2u) / 5u + 1u);
+    fields.dayOfWeek = dayOfWeekFromDays(days);
+}
+
+
+/// Convert calendar values into seconds since 1970-01-01.
+///
+/// The values have to be in the range from 1970-01-01 up to 2106-02-07.
+///
+constexpr inline uint32_t toUnixTime(
+    uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second)
+{
+    return static_cast<uint32_t>(daysFromCivil(year, month, day)) * cSecondsPerDay +
+        static_cast<uint32_t>(hour) * 3600u + static_cast<uint32_t>(minute) * 60u + second;
+}
+
+
+/// Convert calendar values into seconds since 1970-01-01, with a range check.
+///
+/// The 32 bit seconds range from 1970-01-01 00:00:00 up to 2106-02-07 06:28:15.
+///
+/// @param unixTime The variable where the seconds are stored.
+/// @return `true` on success, `false` if the time is outside of the 32 bit range.
+///
+constexpr inline bool toUnixTime(
+    uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second, uint32_t &unixTime)
+{
+    const int64_t time = static_cast<int64_t>(daysFromCivil(year, month, day)) * cSecondsPerDay +
+        static_cast<int64_t>(hour) * 3600 + static_cast<int64_t>(minute) * 60 + second;
+    if (time < 0 || time > static_cast<int64_t>(UINT32_MAX)) {
+        return false;
+    }
+    unixTime = static_cast<uint32_t>(time);
+    return true;
+}
+
+
+/// Convert a date/time into seconds since 1970-01-01.
+///
+inline uint32_t toUnixTime(const DateTime &dateTime)
+{
+    return toUnixTime(dateTime.getYear(), dateTime.getMonth(), dateTime.getDay(),
+        dateTime.getHour(), dateTime.getMinute(), dateTime.getSecond());
+}
+
+
+/// Convert seconds since 1970-01-01 into calendar values.
+///
+inline void fromUnixTime(uint32_t unixTime, Fields &fields)
+{
+    civilFromDays(static_cast<int32_t>(unixTime / cSecondsPerDay), fields);
+    const uint32_t secondOfDay = unixTime % cSecondsPerDay;
+    fields.hour = static_cast<uint8_t>(secondOfDay / 3600u);
+    fields.minute = static_cast<uint8_t>((secondOfDay / 60u) % 60u);
+    fields.second = static_cast<uint8_t>(secondOfDay % 60u);
+}
+
+
+/// Convert seconds since 1970-01-01 into a date/time.
+///
+inline DateTime toDateTime(uint32_t unixTime)
+{
+    Fields fields;
+    fromUnixTime(unixTime, fields);
+    return DateTime::fromUncheckedValues(fields.year, fields.month, fields.day,
+        fields.hour, fields.minute, fields.second, fields.dayOfWeek);
+}
+
+
+}
+}
+
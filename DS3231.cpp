@@ -20,7 +20,9 @@
 #include "DS3231.hpp"
 
 
-#include "../hal-common/BCD.hpp"
+#include "CivilTime.hpp"
+#include "DS3231Bcd.hpp"
+#include "DS3231Codec.hpp"
 
 
 namespace lr {
@@ -59,26 +61,125 @@ struct DS3231::TemperatureRegister {
 
 
 DS3231::DS3231(WireMaster *bus, uint16_t yearBase)
-    : _bus(bus, cChipAddress), _yearBase(yearBase)
+    : _bus(bus, cChipAddress), _yearBase(yearBase), _isCacheEnabled(false), _isCacheValid(false), _cache(),
+    _alarmCache(), _alarmCacheMask(0),
+    _incrementalTimer(nullptr), _isIncrementalValid(false), _incrementalTick(0), _incrementalMinuteTime(0),
+    _incrementalFields(), _retryPolicy()
+#ifdef LR_DS3231_STATISTICS
+    , _statistics(), _statisticsTimer(nullptr)
+#endif
 {
 }
 
 
+DateTime DS3231::decodeDateTime(const DateTimeRegister &data, uint16_t yearBase)
+{
+    return DS3231Codec::decodeDateTime(reinterpret_cast<const uint8_t*>(&data), yearBase);
+}
+
+
+bool DS3231::decodeUnixTime(const DateTimeRegister &data, uint16_t yearBase, uint32_t &unixTime)
+{
+    return DS3231Codec::decodeUnixTime(reinterpret_cast<const uint8_t*>(&data), yearBase, unixTime);
+}
+
+
+bool DS3231::encodeUnixTime(uint32_t unixTime, DateTimeRegister &data) const
+{
+    return DS3231Codec::encodeUnixTime(unixTime, _yearBase, reinterpret_cast<uint8_t*>(&data));
+}
+
+
+float DS3231::decodeTemperature(const TemperatureRegister &data)
+{
+    return static_cast<float>(decodeTemperatureFixed(data)) * 0.25f;
+}
+
+
+int16_t DS3231::decodeTemperatureFixed(const TemperatureRegister &data)
+{
+    return DS3231Codec::decodeTemperatureFixed(reinterpret_cast<const uint8_t*>(&data));
+}
+
+
+DS3231::Status DS3231::begin(const Config &config, bool &isTimeValid)
+{
+    // Read both alarms, control, status and, for the cache, the aging offset in one batch.
+    uint8_t current[cConfigRegisterCount + 1];
+    const uint8_t readCount = (_isCacheEnabled ? sizeof(current) : cConfigRegisterCount);
+    auto status = busRead(Register::Alarm1Seconds, current, readCount);
+    if (hasError(status)) {
+        invalidateCache();
+        return statusFromBus(status);
+    }
+    isTimeValid = ((current[cConfigStatusIndex] & static_cast<uint8_t>(StatusFlag::OSF)) == 0);
+    // Prepare the configured values, in register order. All flags are written as one to keep them.
+    uint8_t data[cConfigRegisterCount];
+    AlarmRegister alarm1;
+    AlarmRegister alarm2;
+    fillAlarmRegister(config.alarm1Mode, config.alarm1, alarm1);
+    fillAlarmRegister(config.alarm2Mode, config.alarm2, alarm2);
+    data[0] = alarm1.seconds;
+    data[1] = alarm1.minutes;
+    data[2] = alarm1.hours;
+    data[3] = alarm1.day;
+    data[4] = alarm2.minutes;
+    data[5] = alarm2.hours;
+    data[6] = alarm2.day;
+    data[cConfigControlIndex] = encodeControl(config.powerProfile);
+    data[cConfigStatusIndex] = static_cast<uint8_t>(cStatusClearableMask | encodeStatus(config.powerProfile));
+    // Find the range of registers which differ, and write it in one burst.
+    current[cConfigControlIndex] &= static_cast<uint8_t>(~static_cast<uint8_t>(ControlFlag::CONV));
+    current[cConfigStatusIndex] = static_cast<uint8_t>(cStatusClearableMask | (current[cConfigStatusIndex] & cStatusWritableMask));
+    uint8_t first = cConfigRegisterCount;
+    uint8_t last = 0;
+    for (uint8_t i = 0; i < cConfigRegisterCount; ++i) {
+        if (current[i] != data[i]) {
+            if (first == cConfigRegisterCount) {
+                first = i;
+            }
+            last = i;
+        }
+    }
+    if (first < cConfigRegisterCount) {
+        status = busWrite(static_cast<Register>(static_cast<uint8_t>(Register::Alarm1Seconds) + first),
+            &data[first], static_cast<uint8_t>(last - first + 1));
+        if (hasError(status)) {
+            invalidateCache();
+            return statusFromBus(status);
+        }
+    }
+    if (_isCacheEnabled) {
+        for (uint8_t i = 0; i < sizeof(_alarmCache); ++i) {
+            _alarmCache[i] = data[i];
+        }
+        _alarmCacheMask = 0b11;
+        _cache.control = data[cConfigControlIndex];
+        _cache.status = static_cast<uint8_t>(data[cConfigStatusIndex] & cStatusWritableMask);
+        _cache.agingOffset = current[cConfigRegisterCount];
+        _isCacheValid = true;
+    }
+    return Status::Success;
+}
+
+
 DS3231::Status DS3231::getDateTime(DateTime &dateTime)
 {
+    if (_incrementalTimer != nullptr) {
+        const auto status = updateIncremental();
+        if (hasError(status)) {
+            return status;
+        }
+        const auto &fields = _incrementalFields;
+        dateTime = DateTime::fromUncheckedValues(fields.year, fields.month, fields.day,
+            fields.hour, fields.minute, fields.second, fields.dayOfWeek);
+        return Status::Success;
+    }
     // Use the struct to read all registers in one batch.
     DateTimeRegister data;
-    const auto status = _bus.readRegisterData(Register::Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(DateTimeRegister));
+    const auto status = busRead(Register::Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(DateTimeRegister));
     if (isSuccessful(status)) {
-        // Convert these values into a date object.
-        dateTime = DateTime::fromUncheckedValues(
-            static_cast<uint16_t>(BCD::convertBcdToBin(data.year))+((data.month&(1<<7))!=0?(_yearBase+100):_yearBase),
-            BCD::convertBcdToBin(data.month&0x1f),
-            BCD::convertBcdToBin(data.day&0x3f),
-            BCD::convertBcdToBin(data.hours&0x3f),
-            BCD::convertBcdToBin(data.minutes&0x7f),
-            BCD::convertBcdToBin(data.seconds&0x7f),
-            data.dayOfWeek&0x7);
+        dateTime = decodeDateTime(data, _yearBase);
         return Status::Success;
     } else {
         return Status::Error;
@@ -86,34 +187,162 @@ DS3231::Status DS3231::getDateTime(DateTime &dateTime)
 }
 
     
+bool DS3231::encodeDateTime(const DateTime &dateTime, DateTimeRegister &data) const
+{
+    return DS3231Codec::encodeDateTime(dateTime, _yearBase, reinterpret_cast<uint8_t*>(&data));
+}
+
+
 DS3231::Status DS3231::setDateTime(const DateTime &dateTime)
 {
-    // Basic year check
-    const uint16_t newYear = dateTime.getYear();
-    if (newYear < _yearBase || newYear >= (_yearBase+200)) {
-        return Status::Error; // The date is outside of the valid range.
-    }
     // Use a struct to write all registers in one batch.
     DateTimeRegister data;
-	// Prepare all values.
-    data.seconds = BCD::convertBinToBcd(dateTime.getSecond());
-    data.minutes = BCD::convertBinToBcd(dateTime.getMinute());
-    data.hours = BCD::convertBinToBcd(dateTime.getHour());
-    data.dayOfWeek = dateTime.getDayOfWeek();
-    data.day = BCD::convertBinToBcd(dateTime.getDay());
-    data.month = BCD::convertBinToBcd(dateTime.getMonth()) |
-        (dateTime.getYear()>=(_yearBase+100)?(1<<7):0);
-    data.year = BCD::convertBinToBcd(dateTime.getYear()%100);
+    if (!encodeDateTime(dateTime, data)) {
+        return Status::Error; // The date is outside of the valid range.
+    }
     // Write all registers.
+    _isIncrementalValid = false;
     return statusFromBus(
-        _bus.writeRegisterData(Register::Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(DateTimeRegister)));
+        busWrite(Register::Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(DateTimeRegister)));
 }
 
     
+DS3231::Status DS3231::getUnixTime(uint32_t &unixTime)
+{
+    if (_incrementalTimer != nullptr) {
+        const auto status = updateIncremental();
+        if (hasError(status)) {
+            return status;
+        }
+        const int64_t time = _incrementalMinuteTime + _incrementalFields.second;
+        if (time < 0 || time > static_cast<int64_t>(UINT32_MAX)) {
+            return Status::Error;
+        }
+        unixTime = static_cast<uint32_t>(time);
+        return Status::Success;
+    }
+    DateTimeRegister data;
+    const auto status = busRead(Register::Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(DateTimeRegister));
+    if (isSuccessful(status) && decodeUnixTime(data, _yearBase, unixTime)) {
+        return Status::Success;
+    } else {
+        return Status::Error;
+    }
+}
+
+
+DS3231::Status DS3231::setUnixTime(uint32_t unixTime)
+{
+    DateTimeRegister data;
+    if (!encodeUnixTime(unixTime, data)) {
+        return Status::Error; // The time is outside of the valid range.
+    }
+    _isIncrementalValid = false;
+    return statusFromBus(
+        busWrite(Register::Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(DateTimeRegister)));
+}
+
+
+DS3231::Status DS3231::setDateTimeAligned(const DateTime &dateTime, uint32_t subsecondOffset, TickFunction microseconds)
+{
+    const uint32_t startTick = microseconds();
+    if (subsecondOffset >= 1000000) {
+        return Status::Error;
+    }
+    // Measure the transfer time using a read of the date/time registers. The read
+    // transmits 10 bytes (address, register, address, 7 values), the seconds value
+    // of the write is latched after the third byte.
+    DateTimeRegister data;
+    const uint32_t readStart = microseconds();
+    if (hasError(busRead(Register::Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(DateTimeRegister)))) {
+        return Status::Error;
+    }
+    const uint32_t latency = (microseconds() - readStart) * 3 / 10;
+    // Find the next second boundary which can be reached in time.
+    uint32_t unixTime = CivilTime::toUnixTime(dateTime) + 1;
+    uint32_t boundary = 1000000 - subsecondOffset;
+    while (boundary < (microseconds() - startTick) + latency) {
+        ++unixTime;
+        boundary += 1000000;
+    }
+    if (!encodeUnixTime(unixTime, data)) {
+        return Status::Error; // The time is outside of the valid range.
+    }
+    // Wait for the boundary and write all registers in one burst.
+    const uint32_t writeStart = boundary - latency;
+    while ((microseconds() - startTick) < writeStart) {
+    }
+    // A retry would be late, so the burst is written exactly once.
+    _isIncrementalValid = false;
+    return statusFromBus(
+        busWriteOnce(Register::Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(DateTimeRegister)));
+}
+
+
+DS3231::Status DS3231::getTimeRecord(DS3231TimeRecord &record)
+{
+    DateTimeRegister data;
+    const auto status = busRead(Register::Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(DateTimeRegister));
+    if (hasError(status)) {
+        return statusFromBus(status);
+    }
+    // The century bit and the two digit year are the offset from the year base.
+    CivilTime::Fields fields;
+    DS3231Codec::decodeFields(reinterpret_cast<const uint8_t*>(&data), 0, fields);
+    if (!DS3231TimeRecord::fromValues(fields.year, fields.month, fields.day,
+        fields.hour, fields.minute, fields.second, 0, record)) {
+        return Status::Error;
+    }
+    return Status::Success;
+}
+
+
+void DS3231::setIncrementalReadEnabled(TickFunction milliseconds)
+{
+    _incrementalTimer = milliseconds;
+    _isIncrementalValid = false;
+}
+
+
+DS3231::Status DS3231::updateIncremental()
+{
+    // Take the time before the read, to never underestimate the elapsed time.
+    const uint32_t tick = _incrementalTimer();
+    if (_isIncrementalValid && (tick - _incrementalTick) < cIncrementalReadWindow) {
+        uint8_t seconds;
+        const auto status = busRead(Register::Seconds, &seconds, 1);
+        if (hasError(status)) {
+            return statusFromBus(status);
+        }
+        const uint8_t second = DS3231Bcd::convertBcdToBin(seconds&DS3231Codec::cSecondsMask);
+        // Less than a minute passed, so the minute is unchanged unless the seconds rolled over.
+        if (second >= _incrementalFields.second) {
+            _incrementalFields.second = second;
+            _incrementalTick = tick;
+            return Status::Success;
+        }
+    }
+    DateTimeRegister data;
+    const auto status = busRead(Register::Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(DateTimeRegister));
+    if (hasError(status)) {
+        _isIncrementalValid = false;
+        return statusFromBus(status);
+    }
+    auto &fields = _incrementalFields;
+    DS3231Codec::decodeFields(reinterpret_cast<const uint8_t*>(&data), _yearBase, fields);
+    // Keep the minute as 64 bit value, the range is checked with the seconds.
+    _incrementalMinuteTime = static_cast<int64_t>(CivilTime::daysFromCivil(fields.year, fields.month, fields.day)) *
+        CivilTime::cSecondsPerDay + static_cast<int64_t>(fields.hour) * 3600 + static_cast<int64_t>(fields.minute) * 60;
+    _incrementalTick = tick;
+    _isIncrementalValid = true;
+    return Status::Success;
+}
+
+
 DS3231::Status DS3231::isRunning(bool &isRunning)
 {
     WireMaster::BitResult bitResult;
-    auto status = _bus.testBits(Register::Status, static_cast<uint8_t>(StatusFlag::OSF), bitResult);
+    auto status = busTestBits(Register::Status, static_cast<uint8_t>(StatusFlag::OSF), bitResult);
     if (hasError(status)) {
         return statusFromBus(status);
     }
@@ -121,7 +350,11 @@ DS3231::Status DS3231::isRunning(bool &isRunning)
         isRunning = false;
         return statusFromBus(status);
     }
-    status = _bus.testBits(Register::Control, static_cast<uint8_t>(ControlFlag::EOSC), bitResult);
+    if (isCacheReady()) {
+        isRunning = ((_cache.control & static_cast<uint8_t>(ControlFlag::EOSC)) == 0);
+        return Status::Success;
+    }
+    status = busTestBits(Register::Control, static_cast<uint8_t>(ControlFlag::EOSC), bitResult);
     if (hasError(status)) {
         return statusFromBus(status);
     }
@@ -133,36 +366,131 @@ DS3231::Status DS3231::isRunning(bool &isRunning)
 DS3231::Status DS3231::enableOscillator()
 {
     // Start the oscillator in the control register.
-    auto status = _bus.changeBits(Register::Control, static_cast<uint8_t>(ControlFlag::EOSC), WireMaster::BitOperation::Clear);
+    const auto status = writeControlBits(static_cast<uint8_t>(ControlFlag::EOSC), 0);
     if (hasError(status)) {
-        return statusFromBus(status);
+        return status;
     }
     // Reset the flag.
-    return statusFromBus(_bus.changeBits(Register::Status, static_cast<uint8_t>(StatusFlag::OSF), WireMaster::BitOperation::Clear));
+    return clearStatusFlags(static_cast<uint8_t>(StatusFlag::OSF));
 }
 
     
 inline void DS3231::fillAlarmRegister(const AlarmMode alarmMode, const DateTime &dateTime, AlarmRegister &data)
 {
-    data.seconds = BCD::convertBinToBcd(dateTime.getSecond())|((static_cast<uint8_t>(alarmMode)&0b00001)!=0?0x80:0x00);
-    data.minutes = BCD::convertBinToBcd(dateTime.getMinute())|((static_cast<uint8_t>(alarmMode)&0b00010)!=0?0x80:0x00);
-    data.hours = BCD::convertBinToBcd(dateTime.getHour())|((static_cast<uint8_t>(alarmMode)&0b00100)!=0?0x80:0x00);
+    data.seconds = DS3231Bcd::convertBinToBcd(dateTime.getSecond())|((static_cast<uint8_t>(alarmMode)&0b00001)!=0?0x80:0x00);
+    data.minutes = DS3231Bcd::convertBinToBcd(dateTime.getMinute())|((static_cast<uint8_t>(alarmMode)&0b00010)!=0?0x80:0x00);
+    data.hours = DS3231Bcd::convertBinToBcd(dateTime.getHour())|((static_cast<uint8_t>(alarmMode)&0b00100)!=0?0x80:0x00);
     if (alarmMode == AlarmMode::DayHoursMinutesSeconds) {
-        data.day = BCD::convertBinToBcd(dateTime.getDayOfWeek()+1)|0b01000000;
+        data.day = DS3231Bcd::convertBinToBcd(dateTime.getDayOfWeek()+1)|0b01000000;
     } else {
-        data.day = BCD::convertBinToBcd(dateTime.getDay());
+        data.day = DS3231Bcd::convertBinToBcd(dateTime.getDay());
     }
     data.day |= ((static_cast<uint8_t>(alarmMode)&0b01000)!=0?0x80:0x00);
 }
     
 
+bool DS3231::decodeAlarmRegister(const AlarmRegister &data, Alarm alarm, uint16_t yearBase,
+    AlarmMode &alarmMode, DateTime &dateTime)
+{
+    // Collect the mask bits, alarm 2 has no seconds register and bit 0 is always zero.
+    uint8_t mode = 0;
+    if (alarm == Alarm::Alarm1 && (data.seconds & 0x80) != 0) {
+        mode |= 0b00001;
+    }
+    if ((data.minutes & 0x80) != 0) {
+        mode |= 0b00010;
+    }
+    if ((data.hours & 0x80) != 0) {
+        mode |= 0b00100;
+    }
+    if ((data.day & 0x80) != 0) {
+        mode |= 0b01000;
+    } else if ((data.day & 0b01000000) != 0) {
+        mode |= 0b10000;
+    }
+    alarmMode = static_cast<AlarmMode>(mode);
+    const uint8_t second = (alarm == Alarm::Alarm1 ? DS3231Bcd::convertBcdToBin(data.seconds&DS3231Codec::cSecondsMask) : 0);
+    const uint8_t minute = DS3231Bcd::convertBcdToBin(data.minutes&DS3231Codec::cMinutesMask);
+    const uint8_t hour = DS3231Bcd::convertBcdToBin(data.hours&DS3231Codec::cHoursMask);
+    if (alarmMode == AlarmMode::DayHoursMinutesSeconds) {
+        const uint8_t dayOfWeek = static_cast<uint8_t>(DS3231Bcd::convertBcdToBin(data.day&0x0f) - 1);
+        dateTime = DateTime::fromUncheckedValues(yearBase, 1, 1, hour, minute, second, dayOfWeek);
+    } else {
+        const uint8_t day = DS3231Bcd::convertBcdToBin(data.day&DS3231Codec::cDayMask);
+        dateTime = DateTime::fromUncheckedValues(yearBase, 1, day, hour, minute, second, 0);
+    }
+    switch (alarmMode) {
+    case AlarmMode::OncePerSecond:
+        return alarm == Alarm::Alarm1;
+    case AlarmMode::SecondsMatch:
+    case AlarmMode::MinutesSeconds:
+    case AlarmMode::HoursMinutesSeconds:
+    case AlarmMode::DateHoursMinutesSeconds:
+    case AlarmMode::DayHoursMinutesSeconds:
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+DS3231::Status DS3231::readAlarmRegister(Alarm alarm, AlarmRegister &data)
+{
+    const uint8_t bit = (alarm == Alarm::Alarm1 ? 0b01 : 0b10);
+    const uint8_t offset = (alarm == Alarm::Alarm1 ? 0 : 1);
+    const uint8_t cacheOffset = (alarm == Alarm::Alarm1 ? 0 : 4);
+    uint8_t *bytes = reinterpret_cast<uint8_t*>(&data);
+    data.seconds = 0;
+    if (_isCacheEnabled && (_alarmCacheMask & bit) != 0) {
+        for (uint8_t i = offset; i < sizeof(AlarmRegister); ++i) {
+            bytes[i] = _alarmCache[cacheOffset + i - offset];
+        }
+        return Status::Success;
+    }
+    const auto status = busRead((alarm == Alarm::Alarm1 ? Register::Alarm1Seconds : Register::Alarm2Minutes),
+        bytes + offset, static_cast<uint8_t>(sizeof(AlarmRegister) - offset));
+    if (hasError(status)) {
+        return statusFromBus(status);
+    }
+    storeAlarmCache(alarm, data);
+    return Status::Success;
+}
+
+
+DS3231::Status DS3231::writeAlarmRegister(Alarm alarm, AlarmRegister &data)
+{
+    const uint8_t offset = (alarm == Alarm::Alarm1 ? 0 : 1);
+    const auto status = busWrite((alarm == Alarm::Alarm1 ? Register::Alarm1Seconds : Register::Alarm2Minutes),
+        reinterpret_cast<uint8_t*>(&data) + offset, static_cast<uint8_t>(sizeof(AlarmRegister) - offset));
+    if (hasError(status)) {
+        _alarmCacheMask &= static_cast<uint8_t>(alarm == Alarm::Alarm1 ? 0b10 : 0b01);
+        return statusFromBus(status);
+    }
+    storeAlarmCache(alarm, data);
+    return Status::Success;
+}
+
+
+void DS3231::storeAlarmCache(Alarm alarm, const AlarmRegister &data)
+{
+    if (!_isCacheEnabled) {
+        return;
+    }
+    const uint8_t offset = (alarm == Alarm::Alarm1 ? 0 : 1);
+    const uint8_t cacheOffset = (alarm == Alarm::Alarm1 ? 0 : 4);
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(&data);
+    for (uint8_t i = offset; i < sizeof(AlarmRegister); ++i) {
+        _alarmCache[cacheOffset + i - offset] = bytes[i];
+    }
+    _alarmCacheMask |= (alarm == Alarm::Alarm1 ? 0b01 : 0b10);
+}
+
+
 DS3231::Status DS3231::setAlarm1(const AlarmMode alarmMode, const lr::DateTime &dateTime)
 {
     AlarmRegister data;
     fillAlarmRegister(alarmMode, dateTime, data);
-    // Write all registers.
-    return statusFromBus(
-         _bus.writeRegisterData(Register::Alarm1Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(AlarmRegister)));
+    return writeAlarmRegister(Alarm::Alarm1, data);
 }
 
     
@@ -170,23 +498,65 @@ DS3231::Status DS3231::setAlarm2(const AlarmMode alarmMode, const lr::DateTime &
 {
     AlarmRegister data;
     fillAlarmRegister(alarmMode, dateTime, data);
-    // Write all registers.
-    return statusFromBus(
-         _bus.writeRegisterData(Register::Alarm2Minutes, reinterpret_cast<uint8_t*>(&data)+1, sizeof(AlarmRegister)-1));
+    return writeAlarmRegister(Alarm::Alarm2, data);
+}
+
+
+DS3231::Status DS3231::getAlarm(Alarm alarm, AlarmMode &alarmMode, DateTime &dateTime)
+{
+    AlarmRegister data;
+    const auto status = readAlarmRegister(alarm, data);
+    if (hasError(status)) {
+        return status;
+    }
+    if (!decodeAlarmRegister(data, alarm, _yearBase, alarmMode, dateTime)) {
+        return Status::Error; // The mask bits do not match any alarm mode.
+    }
+    return Status::Success;
+}
+
+
+DS3231::Status DS3231::getAlarm1(AlarmMode &alarmMode, DateTime &dateTime)
+{
+    return getAlarm(Alarm::Alarm1, alarmMode, dateTime);
+}
+
+
+DS3231::Status DS3231::getAlarm2(AlarmMode &alarmMode, DateTime &dateTime)
+{
+    return getAlarm(Alarm::Alarm2, alarmMode, dateTime);
+}
+
+
+DS3231::Status DS3231::setAlarmIfChanged(Alarm alarm, const AlarmMode alarmMode, const DateTime &dateTime)
+{
+    AlarmRegister data;
+    fillAlarmRegister(alarmMode, dateTime, data);
+    AlarmRegister current;
+    const auto status = readAlarmRegister(alarm, current);
+    if (hasError(status)) {
+        return status;
+    }
+    const bool isSecondsEqual = (alarm == Alarm::Alarm2 || data.seconds == current.seconds);
+    if (isSecondsEqual && data.minutes == current.minutes && data.hours == current.hours &&
+        data.day == current.day) {
+        return Status::Success;
+    }
+    return writeAlarmRegister(alarm, data);
 }
 
     
 DS3231::Status DS3231::isAlarm1Set(bool &isSet)
 {
     WireMaster::BitResult bitResult;
-    auto status = _bus.testBits(Register::Status, static_cast<uint8_t>(StatusFlag::A1F), bitResult);
+    auto status = busTestBits(Register::Status, static_cast<uint8_t>(StatusFlag::A1F), bitResult);
     if (hasError(status)) {
         return statusFromBus(status);
     }
     isSet = (bitResult == WireMaster::BitResult::Set);
     // If the bit is set, clear the bit.
     if (isSet) {
-        _bus.changeBits(Register::Status, static_cast<uint8_t>(StatusFlag::A1F), WireMaster::BitOperation::Clear);
+        return clearStatusFlags(static_cast<uint8_t>(StatusFlag::A1F));
     }
     return statusFromBus(status);
 }
@@ -195,71 +565,779 @@ DS3231::Status DS3231::isAlarm1Set(bool &isSet)
 DS3231::Status DS3231::isAlarm2Set(bool &isSet)
 {
     WireMaster::BitResult bitResult;
-    auto status = _bus.testBits(Register::Status, static_cast<uint8_t>(StatusFlag::A2F), bitResult);
+    auto status = busTestBits(Register::Status, static_cast<uint8_t>(StatusFlag::A2F), bitResult);
     if (hasError(status)) {
         return statusFromBus(status);
     }
     isSet = (bitResult == WireMaster::BitResult::Set);
     // If the bit is set, clear the bit.
     if (isSet) {
-        _bus.changeBits(Register::Status, static_cast<uint8_t>(StatusFlag::A2F), WireMaster::BitOperation::Clear);
+        return clearStatusFlags(static_cast<uint8_t>(StatusFlag::A2F));
     }
     return statusFromBus(status);
 }
 
     
-DS3231::Status DS3231::setIntPinMode(const IntPinMode mode)
+DS3231::Status DS3231::readAndClearAlarms(bool &isAlarm1Set, bool &isAlarm2Set)
 {
-    return statusFromBus(_bus.writeBits(Register::Control, static_cast<uint8_t>(0b00011111), static_cast<uint8_t>(mode)));
+    uint8_t value;
+    auto status = busRead(Register::Status, &value, 1);
+    if (hasError(status)) {
+        return statusFromBus(status);
+    }
+    if (_isCacheValid) {
+        _cache.status = static_cast<uint8_t>(value & cStatusWritableMask);
+    }
+    const uint8_t setFlags = static_cast<uint8_t>(
+        value & (static_cast<uint8_t>(StatusFlag::A1F)|static_cast<uint8_t>(StatusFlag::A2F)));
+    isAlarm1Set = (setFlags & static_cast<uint8_t>(StatusFlag::A1F)) != 0;
+    isAlarm2Set = (setFlags & static_cast<uint8_t>(StatusFlag::A2F)) != 0;
+    if (setFlags == 0) {
+        return Status::Success;
+    }
+    // Writing a one into a flag leaves it unchanged, so only the flags seen as set are cleared.
+    value = static_cast<uint8_t>((value & cStatusWritableMask) | (cStatusClearableMask & ~setFlags));
+    status = busWrite(Register::Status, &value, 1);
+    return statusFromBus(status);
 }
 
 
-DS3231::Status DS3231::getTemperature(float &temperature)
+bool DS3231::selectWakeMode(uint32_t delay, Alarm alarm, AlarmMode &alarmMode)
 {
-    // Read all temperature registers.
-	TemperatureRegister data;
-	const auto status = _bus.readRegisterData(Register::TemperatureHigh, reinterpret_cast<uint8_t*>(&data), sizeof(TemperatureRegister));
-    if (status == WireMaster::Status::Success) {
-        // Create a float from this values.
-        float result = static_cast<float>(data.high);
-        const float fraction = static_cast<float>(data.low >> 6) * 0.25f;
-        if (result < 0) {
-            result -= fraction;
-        } else {
-            result += fraction;
-        }
-        temperature = result;
-        return Status::Success;
+    if (delay == 0 || delay > cMaximumWakeDelay) {
+        return false;
+    }
+    if (alarm == Alarm::Alarm1 && delay < 60) {
+        alarmMode = AlarmMode::SecondsMatch;
+    } else if (alarm == Alarm::Alarm2 && delay <= 60) {
+        alarmMode = AlarmMode::OncePerMinute;
+    } else if (delay < 3600) {
+        alarmMode = AlarmMode::MinutesSeconds;
+    } else if (delay < 86400) {
+        alarmMode = AlarmMode::HoursMinutesSeconds;
     } else {
-        return Status::Error;
+        alarmMode = AlarmMode::DateHoursMinutesSeconds;
     }
+    return true;
 }
 
 
-DS3231::Status DS3231::getAllRegisterValuesAsString(String &str)
+DS3231::Status DS3231::scheduleWakeIn(uint32_t seconds, Alarm alarm)
 {
-    String result;
-    const auto registerCount = getRegisterCount();
-    uint8_t rtcRegister[registerCount];
-    const auto status = _bus.readRegisterData(Register::Seconds, rtcRegister, registerCount);
-    if (status == WireMaster::Status::Success) {
-        for (uint8_t i = 0; i < registerCount; ++i) {
-            result.appendHex(i);
-            result.append(':');
-            const uint8_t value = rtcRegister[i];
-            result.appendHex(value);
-            result.append(':');
-            result.appendBin(value);
-            result.append('\n');
-        }
-        str = result;
-        return Status::Success;
-    } else {
+    uint32_t now;
+    const auto status = getUnixTime(now);
+    if (hasError(status)) {
+        return status;
+    }
+    return programWake(now, now + seconds, alarm);
+}
+
+
+DS3231::Status DS3231::scheduleWakeAt(const DateTime &dateTime, Alarm alarm)
+{
+    return scheduleWakeAt(CivilTime::toUnixTime(dateTime), alarm);
+}
+
+
+DS3231::Status DS3231::scheduleWakeAt(uint32_t unixTime, Alarm alarm)
+{
+    uint32_t now;
+    const auto status = getUnixTime(now);
+    if (hasError(status)) {
+        return status;
+    }
+    return programWake(now, unixTime, alarm);
+}
+
+
+DS3231::Status DS3231::programWake(uint32_t now, uint32_t target, Alarm alarm)
+{
+    if (alarm == Alarm::Alarm2) {
+        target = (target + 59) / 60 * 60; // Alarm 2 has no seconds, never wake too early.
+    }
+    AlarmMode alarmMode;
+    if (target <= now || !selectWakeMode(target - now, alarm, alarmMode)) {
         return Status::Error;
     }
+    const DateTime dateTime = CivilTime::toDateTime(target);
+    Status status;
+    if (alarm == Alarm::Alarm1) {
+        status = setAlarm1(alarmMode, dateTime);
+    } else {
+        status = setAlarm2(alarmMode, dateTime);
+    }
+    if (hasError(status)) {
+        return status;
+    }
+    return clearStatusFlags(static_cast<uint8_t>(
+        alarm == Alarm::Alarm1 ? StatusFlag::A1F : StatusFlag::A2F));
 }
 
 
+DS3231::Status DS3231::setIntPinMode(const IntPinMode mode)
+{
+    return writeControlBits(static_cast<uint8_t>(0b00011111), static_cast<uint8_t>(mode));
+}
+
+
+DS3231::Status DS3231::setAlarmInterruptEnabled(Alarm alarm, bool enabled)
+{
+    const uint8_t mask = static_cast<uint8_t>(alarm == Alarm::Alarm1 ? ControlFlag::A1IE : ControlFlag::A2IE);
+    return writeControlBits(mask, (enabled ? mask : 0));
+}
+
+
+uint8_t DS3231::encodeControl(const PowerProfile &profile)
+{
+    return static_cast<uint8_t>(static_cast<uint8_t>(profile.intPinMode) |
+        (profile.isSquareWaveBatteryBacked ? static_cast<uint8_t>(ControlFlag::BBSQW) : 0));
+}
+
+
+uint8_t DS3231::encodeStatus(const PowerProfile &profile)
+{
+    return (profile.is32kHzOutputEnabled ? static_cast<uint8_t>(StatusFlag::EN32kHz) : 0);
+}
+
+
+DS3231::Status DS3231::setPowerProfile(const PowerProfile &profile)
+{
+    uint8_t data[2];
+    data[0] = encodeControl(profile);
+    data[1] = static_cast<uint8_t>(cStatusClearableMask | encodeStatus(profile));
+    const auto status = busWrite(Register::Control, data, 2);
+    if (hasError(status)) {
+        _isCacheValid = false;
+        return statusFromBus(status);
+    }
+    _cache.control = data[0];
+    _cache.status = encodeStatus(profile);
+    return Status::Success;
+}
+
+
+DS3231::Status DS3231::setPowerProfile(PowerPreset preset)
+{
+    return setPowerProfile(getPowerProfile(preset));
+}
+
+
+DS3231::PowerProfile DS3231::getPowerProfile(PowerPreset preset)
+{
+    switch (preset) {
+    case PowerPreset::DeepSleepWakeOnAlarm:
+        return PowerProfile{IntPinMode::Alarm12, false, false};
+    case PowerPreset::TimebaseProvider:
+        return PowerProfile{IntPinMode::SquareWave1Hz, false, true};
+    default:
+        return PowerProfile{IntPinMode::Disabled, false, false};
+    }
 }
 
 
+DS3231::Status DS3231::set32kHzOutput(bool enabled)
+{
+    // EN32kHz is the only writable bit, writing a one into the flags leaves them unchanged.
+    const uint8_t enableBit = (enabled ? static_cast<uint8_t>(StatusFlag::EN32kHz) : 0);
+    uint8_t value = static_cast<uint8_t>(cStatusClearableMask | enableBit);
+    const auto status = busWrite(Register::Status, &value, 1);
+    if (hasError(status)) {
+        _isCacheValid = false;
+        return statusFromBus(status);
+    }
+    _cache.status = enableBit;
+    return Status::Success;
+}
+
+
+DS3231::Status DS3231::is32kHzOutputEnabled(bool &enabled)
+{
+    if (isCacheReady()) {
+        enabled = ((_cache.status & static_cast<uint8_t>(StatusFlag::EN32kHz)) != 0);
+        return Status::Success;
+    }
+    WireMaster::BitResult bitResult;
+    const auto status = busTestBits(Register::Status, static_cast<uint8_t>(StatusFlag::EN32kHz), bitResult);
+    if (hasError(status)) {
+        return statusFromBus(status);
+    }
+    enabled = (bitResult == WireMaster::BitResult::Set);
+    return Status::Success;
+}
+
+
+DS3231::Status DS3231::getTemperature(float &temperature)
+{
+    // Read all temperature registers.
+	TemperatureRegister data;
+	const auto status = busRead(Register::TemperatureHigh, reinterpret_cast<uint8_t*>(&data), sizeof(TemperatureRegister));
+    if (status == WireMaster::Status::Success) {
+        temperature = decodeTemperature(data);
+        return Status::Success;
+    } else {
+        return Status::Error;
+    }
+}
+
+
+DS3231::Batch::Batch(DS3231 *rtc)
+    : _rtc(rtc), _data(), _dirtyMask(0), _controlMask(0), _controlBits(0)
+{
+}
+
+
+DS3231::Status DS3231::Batch::setDateTime(const DateTime &dateTime)
+{
+    DateTimeRegister data;
+    if (!_rtc->encodeDateTime(dateTime, data)) {
+        return Status::Error; // The date is outside of the valid range.
+    }
+    setRegisters(Register::Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(DateTimeRegister));
+    return Status::Success;
+}
+
+
+void DS3231::Batch::setAlarm1(const AlarmMode alarmMode, const DateTime &dateTime)
+{
+    AlarmRegister data;
+    _rtc->fillAlarmRegister(alarmMode, dateTime, data);
+    setRegisters(Register::Alarm1Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(AlarmRegister));
+}
+
+
+void DS3231::Batch::setAlarm2(const AlarmMode alarmMode, const DateTime &dateTime)
+{
+    AlarmRegister data;
+    _rtc->fillAlarmRegister(alarmMode, dateTime, data);
+    setRegisters(Register::Alarm2Minutes, reinterpret_cast<uint8_t*>(&data)+1, sizeof(AlarmRegister)-1);
+}
+
+
+void DS3231::Batch::setIntPinMode(const IntPinMode mode)
+{
+    _controlMask = static_cast<uint8_t>(0b00011111);
+    _controlBits = static_cast<uint8_t>(mode);
+}
+
+
+void DS3231::Batch::clear()
+{
+    _dirtyMask = 0;
+    _controlMask = 0;
+    _controlBits = 0;
+}
+
+
+void DS3231::Batch::setRegisters(Register first, const uint8_t *data, uint8_t count)
+{
+    const uint8_t firstIndex = static_cast<uint8_t>(first);
+    for (uint8_t i = 0; i < count; ++i) {
+        _data[firstIndex + i] = data[i];
+        _dirtyMask |= static_cast<uint16_t>(1u << (firstIndex + i));
+    }
+}
+
+
+DS3231::Status DS3231::Batch::commit()
+{
+    const uint8_t controlIndex = static_cast<uint8_t>(Register::Control);
+    if (_controlMask != 0) {
+        // Get the current value of the control register to merge the changed bits.
+        uint8_t control;
+        if (_rtc->isCacheReady()) {
+            control = _rtc->_cache.control;
+        } else {
+            const auto status = _rtc->busRead(Register::Control, &control, 1);
+            if (hasError(status)) {
+                return statusFromBus(status);
+            }
+            control &= ~static_cast<uint8_t>(ControlFlag::CONV);
+        }
+        _data[controlIndex] = static_cast<uint8_t>((control & ~_controlMask) | (_controlBits & _controlMask));
+        _dirtyMask |= static_cast<uint16_t>(1u << controlIndex);
+    }
+    // Write each range of changed registers in one burst.
+    uint8_t index = 0;
+    while (index < cRegisterCount) {
+        if ((_dirtyMask & (1u << index)) == 0) {
+            ++index;
+            continue;
+        }
+        const uint8_t first = index;
+        while (index < cRegisterCount && (_dirtyMask & (1u << index)) != 0) {
+            ++index;
+        }
+        const auto status = _rtc->busWrite(
+            static_cast<Register>(first), &_data[first], static_cast<uint8_t>(index - first));
+        if (hasError(status)) {
+            _rtc->invalidateCache();
+            return statusFromBus(status);
+        }
+    }
+    _rtc->_isIncrementalValid = false;
+    _rtc->_alarmCacheMask = 0;
+    if (_controlMask != 0 && _rtc->_isCacheValid) {
+        _rtc->_cache.control = _data[controlIndex];
+    }
+    clear();
+    return Status::Success;
+}
+
+
+DS3231::Status DS3231::readSnapshot(Snapshot &snapshot)
+{
+    const auto status = busRead(Register::Seconds, snapshot.registers, getRegisterCount());
+    if (hasError(status)) {
+        return statusFromBus(status);
+    }
+    snapshot.yearBase = _yearBase;
+    // Use the read values to refresh the cache.
+    if (_isCacheEnabled) {
+        _cache.control = static_cast<uint8_t>(
+            snapshot.getRegister(Register::Control) & ~static_cast<uint8_t>(ControlFlag::CONV));
+        _cache.status = static_cast<uint8_t>(snapshot.getRegister(Register::Status) & cStatusWritableMask);
+        _cache.agingOffset = snapshot.getRegister(Register::AgingOffset);
+        _isCacheValid = true;
+    }
+    return Status::Success;
+}
+
+
+DateTime DS3231::Snapshot::getDateTime() const
+{
+    return decodeDateTime(*reinterpret_cast<const DateTimeRegister*>(&registers[static_cast<uint8_t>(Register::Seconds)]), yearBase);
+}
+
+
+bool DS3231::Snapshot::getUnixTime(uint32_t &unixTime) const
+{
+    return decodeUnixTime(*reinterpret_cast<const DateTimeRegister*>(&registers[static_cast<uint8_t>(Register::Seconds)]), yearBase, unixTime);
+}
+
+
+bool DS3231::Snapshot::isRunning() const
+{
+    return (getRegister(Register::Status) & static_cast<uint8_t>(StatusFlag::OSF)) == 0 &&
+        (getRegister(Register::Control) & static_cast<uint8_t>(ControlFlag::EOSC)) == 0;
+}
+
+
+bool DS3231::Snapshot::isAlarm1Set() const
+{
+    return (getRegister(Register::Status) & static_cast<uint8_t>(StatusFlag::A1F)) != 0;
+}
+
+
+bool DS3231::Snapshot::isAlarm2Set() const
+{
+    return (getRegister(Register::Status) & static_cast<uint8_t>(StatusFlag::A2F)) != 0;
+}
+
+
+float DS3231::Snapshot::getTemperature() const
+{
+    return decodeTemperature(*reinterpret_cast<const TemperatureRegister*>(&registers[static_cast<uint8_t>(Register::TemperatureHigh)]));
+}
+
+
+int16_t DS3231::Snapshot::getTemperatureFixed() const
+{
+    return decodeTemperatureFixed(*reinterpret_cast<const TemperatureRegister*>(&registers[static_cast<uint8_t>(Register::TemperatureHigh)]));
+}
+
+
+void DS3231::setCacheEnabled(bool enabled)
+{
+    _isCacheEnabled = enabled;
+    _isCacheValid = false;
+    _alarmCacheMask = 0;
+}
+
+
+DS3231::Status DS3231::syncCache()
+{
+    // Read the three registers in one batch, they are in sequence.
+    RegisterCache data;
+    const auto status = busRead(Register::Control, reinterpret_cast<uint8_t*>(&data), sizeof(RegisterCache));
+    if (hasError(status)) {
+        _isCacheValid = false;
+        return statusFromBus(status);
+    }
+    data.control &= ~static_cast<uint8_t>(ControlFlag::CONV);
+    data.status &= cStatusWritableMask;
+    _cache = data;
+    _isCacheValid = true;
+    return Status::Success;
+}
+
+
+bool DS3231::isCacheReady()
+{
+    if (!_isCacheEnabled) {
+        return false;
+    }
+    if (!_isCacheValid) {
+        return isSuccessful(syncCache());
+    }
+    return true;
+}
+
+
+DS3231::Status DS3231::writeControlBits(uint8_t mask, uint8_t bits)
+{
+    if (isCacheReady()) {
+        // Write the new value directly, without reading the register first.
+        uint8_t value = static_cast<uint8_t>((_cache.control & ~mask) | (bits & mask));
+        const auto status = busWrite(Register::Control, &value, 1);
+        if (hasError(status)) {
+            _isCacheValid = false;
+            return statusFromBus(status);
+        }
+        _cache.control = static_cast<uint8_t>(value & ~static_cast<uint8_t>(ControlFlag::CONV));
+        return Status::Success;
+    }
+    return statusFromBus(busWriteBits(Register::Control, mask, bits));
+}
+
+
+DS3231::Status DS3231::clearStatusFlags(uint8_t flags)
+{
+    if (isCacheReady()) {
+        // Writing a one into a flag leaves it unchanged, so a single write only clears the given flags.
+        uint8_t value = static_cast<uint8_t>(_cache.status | (cStatusClearableMask & ~flags));
+        const auto status = busWrite(Register::Status, &value, 1);
+        if (hasError(status)) {
+            _isCacheValid = false;
+        }
+        return statusFromBus(status);
+    }
+    return statusFromBus(busChangeBits(Register::Status, flags, WireMaster::BitOperation::Clear));
+}
+
+
+#ifdef LR_DS3231_STATISTICS
+
+
+void DS3231::resetStatistics()
+{
+    _statistics = Statistics();
+}
+
+
+inline uint32_t DS3231::statisticsStart() const
+{
+    return (_statisticsTimer != nullptr) ? _statisticsTimer() : 0;
+}
+
+
+inline void DS3231::statisticsRetry(bool isRecovered)
+{
+    ++_statistics.retryCount;
+    if (isRecovered) {
+        ++_statistics.recoveryCount;
+    }
+}
+
+
+inline void DS3231::statisticsRecord(WireMaster::Status status, uint8_t reads, uint8_t writes, uint8_t bytes, uint32_t startTime)
+{
+    _statistics.readCount += reads;
+    _statistics.writeCount += writes;
+    _statistics.byteCount += bytes;
+    if (hasError(status)) {
+        ++_statistics.errorCount;
+    }
+    if (_statisticsTimer != nullptr) {
+        _statistics.busTime += _statisticsTimer() - startTime;
+    }
+}
+
+
+#else
+
+
+inline uint32_t DS3231::statisticsStart() const
+{
+    return 0;
+}
+
+
+inline void DS3231::statisticsRetry(bool)
+{
+}
+
+
+inline void DS3231::statisticsRecord(WireMaster::Status, uint8_t, uint8_t, uint8_t, uint32_t)
+{
+}
+
+
+#endif
+
+
+template<typename tFunction>
+WireMaster::Status DS3231::withRetry(tFunction function)
+{
+    auto status = function();
+    if (isSuccessful(status) || _retryPolicy.maximumAttempts <= 1) {
+        return status;
+    }
+    uint32_t backoff = _retryPolicy.initialBackoff;
+    uint32_t remainingBudget = _retryPolicy.backoffBudget;
+    for (uint8_t attempt = 1; attempt < _retryPolicy.maximumAttempts; ++attempt) {
+        if (_retryPolicy.recoverBus != nullptr) {
+            _retryPolicy.recoverBus();
+            statisticsRetry(true);
+        } else {
+            statisticsRetry(false);
+        }
+        // Wait with an exponential backoff, until the budget is used up.
+        if (_retryPolicy.delay != nullptr && backoff > 0 && remainingBudget > 0) {
+            const uint32_t waitTime = (backoff < remainingBudget) ? backoff : remainingBudget;
+            _retryPolicy.delay(waitTime);
+            remainingBudget -= waitTime;
+            backoff *= 2;
+        }
+        status = function();
+        if (isSuccessful(status)) {
+            return status;
+        }
+    }
+    return status;
+}
+
+
+WireMaster::Status DS3231::busRead(Register reg, uint8_t *data, uint8_t count)
+{
+    return withRetry([&]() {
+        const uint32_t startTime = statisticsStart();
+        const auto status = _bus.readRegisterData(reg, data, count);
+        statisticsRecord(status, 1, 0, static_cast<uint8_t>(3 + count), startTime);
+        return status;
+    });
+}
+
+
+WireMaster::Status DS3231::busWrite(Register reg, uint8_t *data, uint8_t count)
+{
+    return withRetry([&]() {
+        return busWriteOnce(reg, data, count);
+    });
+}
+
+
+WireMaster::Status DS3231::busWriteOnce(Register reg, uint8_t *data, uint8_t count)
+{
+    const uint32_t startTime = statisticsStart();
+    const auto status = _bus.writeRegisterData(reg, data, count);
+    statisticsRecord(status, 0, 1, static_cast<uint8_t>(2 + count), startTime);
+    return status;
+}
+
+
+WireMaster::Status DS3231::busWriteBits(Register reg, uint8_t mask, uint8_t bits)
+{
+    return withRetry([&]() {
+        const uint32_t startTime = statisticsStart();
+        const auto status = _bus.writeBits(reg, mask, bits);
+        statisticsRecord(status, 1, 1, 7, startTime);
+        return status;
+    });
+}
+
+
+WireMaster::Status DS3231::busChangeBits(Register reg, uint8_t mask, WireMaster::BitOperation operation)
+{
+    return withRetry([&]() {
+        const uint32_t startTime = statisticsStart();
+        const auto status = _bus.changeBits(reg, mask, operation);
+        statisticsRecord(status, 1, 1, 7, startTime);
+        return status;
+    });
+}
+
+
+WireMaster::Status DS3231::busTestBits(Register reg, uint8_t mask, WireMaster::BitResult &result)
+{
+    return withRetry([&]() {
+        const uint32_t startTime = statisticsStart();
+        const auto status = _bus.testBits(reg, mask, result);
+        statisticsRecord(status, 1, 0, 4, startTime);
+        return status;
+    });
+}
+
+
+DS3231::Status DS3231::getTemperatureFixed(int16_t &quarterDegrees)
+{
+    TemperatureRegister data;
+    const auto status = busRead(Register::TemperatureHigh, reinterpret_cast<uint8_t*>(&data), sizeof(TemperatureRegister));
+    if (hasError(status)) {
+        return statusFromBus(status);
+    }
+    quarterDegrees = decodeTemperatureFixed(data);
+    return Status::Success;
+}
+
+
+DS3231::Status DS3231::readControlAndStatus(uint8_t (&data)[2])
+{
+    // Both registers are in sequence and read in one batch.
+    const auto status = busRead(Register::Control, data, 2);
+    if (hasError(status)) {
+        return statusFromBus(status);
+    }
+    if (_isCacheValid) {
+        _cache.control = static_cast<uint8_t>(data[0] & ~static_cast<uint8_t>(ControlFlag::CONV));
+        _cache.status = static_cast<uint8_t>(data[1] & cStatusWritableMask);
+    }
+    return Status::Success;
+}
+
+
+DS3231::Status DS3231::triggerTemperatureConversion(bool &isStarted)
+{
+    uint8_t data[2];
+    auto status = readControlAndStatus(data);
+    if (hasError(status)) {
+        return status;
+    }
+    if ((data[0] & static_cast<uint8_t>(ControlFlag::CONV)) != 0 ||
+        (data[1] & static_cast<uint8_t>(StatusFlag::BSY)) != 0) {
+        isStarted = false;
+        return Status::Success;
+    }
+    uint8_t value = static_cast<uint8_t>(data[0] | static_cast<uint8_t>(ControlFlag::CONV));
+    status = statusFromBus(busWrite(Register::Control, &value, 1));
+    isStarted = isSuccessful(status);
+    return status;
+}
+
+
+DS3231::Status DS3231::isConversionBusy(bool &isBusy)
+{
+    uint8_t data[2];
+    const auto status = readControlAndStatus(data);
+    if (hasError(status)) {
+        return status;
+    }
+    isBusy = (data[0] & static_cast<uint8_t>(ControlFlag::CONV)) != 0 ||
+        (data[1] & static_cast<uint8_t>(StatusFlag::BSY)) != 0;
+    return Status::Success;
+}
+
+
+DS3231::Status DS3231::getAgingOffset(int8_t &offset)
+{
+    if (isCacheReady()) {
+        offset = static_cast<int8_t>(_cache.agingOffset);
+        return Status::Success;
+    }
+    uint8_t value;
+    const auto status = busRead(Register::AgingOffset, &value, 1);
+    if (hasError(status)) {
+        return statusFromBus(status);
+    }
+    offset = static_cast<int8_t>(value);
+    return Status::Success;
+}
+
+
+DS3231::Status DS3231::setAgingOffset(int8_t offset)
+{
+    uint8_t value = static_cast<uint8_t>(offset);
+    const auto status = busWrite(Register::AgingOffset, &value, 1);
+    if (hasError(status)) {
+        _isCacheValid = false;
+        return statusFromBus(status);
+    }
+    _cache.agingOffset = value;
+    return Status::Success;
+}
+
+
+DS3231::Status DS3231::getAllRegisterValuesAsString(String &str)
+{
+    String result;
+    constexpr auto registerCount = getRegisterCount();
+    uint8_t rtcRegister[registerCount];
+    const auto status = busRead(Register::Seconds, rtcRegister, registerCount);
+    if (status == WireMaster::Status::Success) {
+        for (uint8_t i = 0; i < registerCount; ++i) {
+            result.appendHex(i);
+            result.append(':');
+            const uint8_t value = rtcRegister[i];
+            result.appendHex(value);
+            result.append(':');
+            result.appendBin(value);
+            result.append('\n');
+        }
+        str = result;
+        return Status::Success;
+    } else {
+        return Status::Error;
+    }
+}
+
+
+DS3231::Status DS3231::writeAllRegisterValues(CharacterSink sink, void *context)
+{
+    constexpr auto registerCount = getRegisterCount();
+    uint8_t rtcRegister[registerCount];
+    const auto status = busRead(Register::Seconds, rtcRegister, registerCount);
+    if (hasError(status)) {
+        return statusFromBus(status);
+    }
+    const char hexDigits[] = "0123456789abcdef";
+    for (uint8_t i = 0; i < registerCount; ++i) {
+        const uint8_t value = rtcRegister[i];
+        sink(hexDigits[i >> 4], context);
+        sink(hexDigits[i & 0xf], context);
+        sink(':', context);
+        sink(hexDigits[value >> 4], context);
+        sink(hexDigits[value & 0xf], context);
+        sink(':', context);
+        for (uint8_t bit = 0; bit < 8; ++bit) {
+            sink((value & (0x80 >> bit)) != 0 ? '1' : '0', context);
+        }
+        sink('\n', context);
+    }
+    return Status::Success;
+}
+
+
+/// @internal
+/// The context to write a text dump into a buffer.
+///
+struct DS3231BufferSink {
+    char *buffer;
+    uint16_t size;
+    uint16_t length;
+};
+
+
+DS3231::Status DS3231::writeAllRegisterValues(char *buffer, uint16_t size)
+{
+    if (size == 0) {
+        return Status::Error;
+    }
+    DS3231BufferSink bufferSink = {buffer, size, 0};
+    const auto status = writeAllRegisterValues([](char c, void *context) {
+        auto sink = static_cast<DS3231BufferSink*>(context);
+        if (sink->length + 1 < sink->size) {
+            sink->buffer[sink->length++] = c;
+        }
+    }, &bufferSink);
+    buffer[bufferSink.length] = '\0';
+    return status;
+}
+
+
+DS3231::Status DS3231::readRegisterDump(uint8_t *buffer)
+{
+    return statusFromBus(busRead(Register::Seconds, buffer, getRegisterCount()));
+}
+
+
+}
+
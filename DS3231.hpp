@@ -20,6 +20,9 @@
 //
 
 
+#include "CivilTime.hpp"
+#include "DS3231TimeRecord.hpp"
+
 #include "hal-common/BitTools.hpp"
 #include "hal-common/DateTime.hpp"
 #include "hal-common/Flags.hpp"
@@ -40,6 +43,12 @@ public:
     ///
     using Status = CallStatus;
 
+    /// A function returning a free running tick counter of the host.
+    ///
+    /// The counter has to increase at a constant rate and wrap around at 32 bit.
+    ///
+    using TickFunction = uint32_t(*)();
+
     /// The alarm mode.
     ///
     /// The modes `OncePerSecond` and `SecondsMatch` are only valid for alarm 1.
@@ -60,18 +69,57 @@ public:
         DayHoursMinutesSeconds = 0b10000, ///< Alarm when the day of the week, hours minutes and seconds match.
     };
     
+    /// The two alarms of the chip.
+    ///
+    enum class Alarm : uint8_t {
+        Alarm1, ///< Alarm 1, with a resolution of seconds.
+        Alarm2, ///< Alarm 2, with a resolution of minutes.
+    };
+
+    /// The maximum delay for a planned wake up in seconds.
+    ///
+    /// The alarm with the date of the month repeats after 28 days at the earliest.
+    ///
+    constexpr static const uint32_t cMaximumWakeDelay = 28ul*86400ul-1ul;
+
     /// The mode of the INT/SQW pin on the chip.
     ///
     enum class IntPinMode : uint8_t {
-        Disabled = 0b00000, ///< The pin is disabled.
+        Disabled = 0b00100, ///< The pin is disabled.
         Alarm1 = 0b00101, ///< The pin is driven low if alarm 1 matches.
-        Alarm2 = 0b00101, ///< The pin is driven low if alarm 2 matches.
-        Alarm12 = 0b00101, ///< The pin is driven low if alarm 1 or 2 matches.
+        Alarm2 = 0b00110, ///< The pin is driven low if alarm 2 matches.
+        Alarm12 = 0b00111, ///< The pin is driven low if alarm 1 or 2 matches.
         SquareWave1Hz = 0b00000, ///< The pin outputs a 1Hz square wave signal.
         SquareWave1024Hz = 0b01000, ///< The pin outputs a 1.024kHz square wave signal.
         SquareWave4096Hz = 0b10000, ///< The pin outputs a 4.096kHz square wave signal.
         SquareWave8192Hz = 0b11000, ///< The pin outputs a 8.192kHz square wave signal.
     };
+
+    /// The configuration of all outputs of the chip.
+    ///
+    struct PowerProfile {
+        IntPinMode intPinMode; ///< The mode of the INT/SQW pin.
+        bool isSquareWaveBatteryBacked; ///< If the square wave is also generated on battery power.
+        bool is32kHzOutputEnabled; ///< If the 32kHz output is enabled.
+    };
+
+    /// Predefined power profiles.
+    ///
+    enum class PowerPreset : uint8_t {
+        DeepSleepWakeOnAlarm, ///< The INT pin signals both alarms, the 32kHz output is off.
+        TimebaseProvider, ///< The pin outputs 1Hz and the 32kHz output is on.
+        FullyOff, ///< All outputs are off, for the lowest battery current.
+    };
+
+    /// The configuration of the chip for `begin()`.
+    ///
+    struct Config {
+        PowerProfile powerProfile; ///< The configuration of the outputs.
+        AlarmMode alarm1Mode; ///< The mode of alarm 1.
+        DateTime alarm1; ///< The date/time of alarm 1.
+        AlarmMode alarm2Mode; ///< The mode of alarm 2.
+        DateTime alarm2; ///< The date/time of alarm 2.
+    };
     
 public:
     /// Initialize the real time clock driver.
@@ -82,10 +130,37 @@ public:
     ///    additional bit for the next century. If you set the
     ///    year base to `2000`, the RTC will hold the correct time
     ///    for 200 years, starting from `2000-01-01 00:00:00`.
+    ///    The functions using seconds since 1970-01-01 require a
+    ///    year base of 1970 or later, and report an error for
+    ///    times after 2106-02-07 06:28:15.
     ///
     DS3231(WireMaster *bus, uint16_t yearBase = 2000);
 
 public:
+    /// Get the year base of the RTC.
+    ///
+    inline uint16_t getYearBase() const {
+        return _yearBase;
+    }
+
+    /// Initialize the chip with the given configuration.
+    ///
+    /// The alarm, control and status registers are read in a single transfer and
+    /// compared with the configuration. Only the range from the first to the last
+    /// differing register is written, in one burst. If nothing differs, nothing
+    /// is written. No status flag is cleared, so after a power loss the `OSF` flag
+    /// stays set until `enableOscillator()` is called after setting the time.
+    ///
+    /// With the register cache enabled, the aging offset is read in the same
+    /// transfer, and the register and alarm caches are filled.
+    ///
+    /// @param[in] config The configuration for the chip.
+    /// @param[out] isTimeValid Set to `false` if the chip lost its power and the
+    ///     time has to be set.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status begin(const Config &config, bool &isTimeValid);
+
     /// Get the current date/time.
     ///
     /// @param[out] dateTime The variable where the read date/time is stored.
@@ -100,6 +175,83 @@ public:
     ///
     Status setDateTime(const DateTime &dateTime);
 
+    /// Get the current time as seconds since 1970-01-01.
+    ///
+    /// The time is converted directly from the registers, without creating a
+    /// `DateTime` object. The time in the chip is treated as UTC. The 32 bit
+    /// seconds end at 2106-02-07 06:28:15, a later time of the chip is an error.
+    ///
+    /// @param[out] unixTime The variable where the read time is stored.
+    /// @return `Success` or `Error` if there was a communication problem with the chip,
+    ///     or the time of the chip is after 2106-02-07 06:28:15.
+    ///
+    Status getUnixTime(uint32_t &unixTime);
+
+    /// Set the time using seconds since 1970-01-01.
+    ///
+    /// @param[in] unixTime The new time to write to the chip.
+    /// @return `Success` or `Error` if there was a communication problem with the chip,
+    ///     or the time is outside of the range of the year base.
+    ///
+    Status setUnixTime(uint32_t unixTime);
+
+    /// Set the date/time aligned to the second boundary of a reference clock.
+    ///
+    /// The chip resets its internal one second countdown when the seconds register
+    /// is written. This method waits for the next full second of the reference time
+    /// and writes all registers in one burst, so the seconds register is latched
+    /// exactly at this boundary. The duration of the transfer is measured with a
+    /// read of the date/time registers first, and the write is started early by the
+    /// time required to transmit the address, register and seconds bytes.
+    ///
+    /// The reference time is `dateTime` plus `subsecondOffset` at the moment this
+    /// method is called. The method blocks for up to one second.
+    ///
+    /// The final burst is never retried, even with a retry policy, because a
+    /// repeated write would miss the boundary. If it fails, `Error` is returned
+    /// and the method can be called again to align with a later second.
+    ///
+    /// @param[in] dateTime The current date/time of the reference clock.
+    /// @param[in] subsecondOffset The microseconds elapsed since the start of the
+    ///     second in `dateTime`. Must be less than 1000000.
+    /// @param[in] microseconds A tick function returning microseconds.
+    /// @return `Success` or `Error` if there was a communication problem with the chip,
+    ///     the time is outside of the range of the year base, or the offset is invalid.
+    ///
+    Status setDateTimeAligned(const DateTime &dateTime, uint32_t subsecondOffset, TickFunction microseconds);
+
+    /// Get the current time as packed record.
+    ///
+    /// The record is packed directly from the register values, without creating
+    /// a `DateTime` object. The year offset of the record is relative to the year
+    /// base of this driver. The 4 byte record only covers 64 of the 200 years
+    /// of the chip, e.g. 2000 to 2063 for the year base 2000. After this window,
+    /// this method returns `Error`. For a record with milliseconds, use
+    /// `DS3231Clock::getTimeRecord()`.
+    ///
+    /// @param[out] record The variable where the record is stored.
+    /// @return `Success` or `Error` if there was a communication problem with the chip,
+    ///     or the year is outside of the range of the record.
+    ///
+    Status getTimeRecord(DS3231TimeRecord &record);
+
+    /// Enable or disable incremental reads of the date/time.
+    ///
+    /// If enabled, `getDateTime()` and `getUnixTime()` keep the last read values and
+    /// only read the seconds register, as long as the minute can not have changed.
+    /// This is detected using a rollover of the seconds, and the elapsed time
+    /// measured with the given timer. All seven registers are read after a rollover,
+    /// or if more than `cIncrementalReadWindow` milliseconds passed since the last read.
+    ///
+    /// @param[in] milliseconds A tick function returning milliseconds, or `nullptr` to
+    ///     disable incremental reads.
+    ///
+    void setIncrementalReadEnabled(TickFunction milliseconds);
+
+    /// The maximum time between incremental reads in milliseconds.
+    ///
+    constexpr static const uint32_t cIncrementalReadWindow = 59000;
+
     /// Check if the RTC is running.
     ///
     /// If this method returns `false`, the RTC lost its power and you have to
@@ -137,6 +289,41 @@ public:
     /// @return `Success` or `Error` if there was a communication problem with the chip.
     ///
     Status setAlarm2(const AlarmMode alarmMode, const DateTime &dateTime = DateTime());
+
+    /// Get the first alarm.
+    ///
+    /// This is the inverse of `setAlarm1()`. The date/time uses the year base and
+    /// January as year and month. If the alarm matches the day of the week, the day
+    /// of the week is set and the day of the month is `1`.
+    ///
+    /// @param[out] alarmMode The variable where the alarm mode is stored.
+    /// @param[out] dateTime The variable where the date/time of the alarm is stored.
+    /// @return `Success` or `Error` if there was a communication problem with the chip,
+    ///     or the registers contain a combination of mask bits without a matching mode.
+    ///
+    Status getAlarm1(AlarmMode &alarmMode, DateTime &dateTime);
+
+    /// Get the second alarm.
+    ///
+    /// This is the inverse of `setAlarm2()`. The seconds of the date/time are zero.
+    ///
+    /// @see getAlarm1()
+    ///
+    Status getAlarm2(AlarmMode &alarmMode, DateTime &dateTime);
+
+    /// Set an alarm, only if it differs from the current one.
+    ///
+    /// The encoded alarm registers are compared with the current values and only
+    /// written if they differ. With the register cache enabled, the alarm registers
+    /// are read once and then compared with the cached copy, so an unchanged alarm
+    /// costs no bus transfer. Without the cache, the registers are read each time.
+    ///
+    /// @param[in] alarm The alarm to set.
+    /// @param[in] alarmMode The alarm mode to set.
+    /// @param[in] dateTime The date/time for the alarm to set.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status setAlarmIfChanged(Alarm alarm, const AlarmMode alarmMode, const DateTime &dateTime = DateTime());
     
     /// Check if alarm 1 is set and clear the alarm.
     ///
@@ -152,10 +339,119 @@ public:
     ///
     Status isAlarm2Set(bool &isSet);
 
+    /// Check both alarms and clear the alarm flags which are set.
+    ///
+    /// This method reads the status register once and clears all set alarm
+    /// flags with a single write.
+    ///
+    /// @param[out] isAlarm1Set If alarm 1 was set.
+    /// @param[out] isAlarm2Set If alarm 2 was set.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status readAndClearAlarms(bool &isAlarm1Set, bool &isAlarm2Set);
+
+    /// Program an alarm to wake up after the given number of seconds.
+    ///
+    /// The current time is read from the chip and the alarm is programmed with
+    /// the coarsest mode which matches the target time exactly once. After
+    /// programming, the flag of the alarm is cleared to release the INT pin.
+    /// Alarm 2 has no seconds, for it the target is rounded up to the next minute.
+    ///
+    /// @param[in] seconds The delay in seconds, one up to `cMaximumWakeDelay`.
+    /// @param[in] alarm The alarm to use.
+    /// @return `Success` or `Error` if there was a communication problem with the chip,
+    ///     or the delay is outside of the valid range.
+    ///
+    Status scheduleWakeIn(uint32_t seconds, Alarm alarm = Alarm::Alarm1);
+
+    /// Program an alarm to wake up at the given time.
+    ///
+    /// @see scheduleWakeIn()
+    /// @param[in] dateTime The time to wake up, at most `cMaximumWakeDelay` seconds in the future.
+    /// @param[in] alarm The alarm to use.
+    /// @return `Success` or `Error` if there was a communication problem with the chip,
+    ///     or the time is not in the valid range.
+    ///
+    Status scheduleWakeAt(const DateTime &dateTime, Alarm alarm = Alarm::Alarm1);
+
+    /// Program an alarm to wake up at the given time in seconds since 1970-01-01.
+    ///
+    /// @see scheduleWakeAt()
+    ///
+    Status scheduleWakeAt(uint32_t unixTime, Alarm alarm = Alarm::Alarm1);
+
+    /// Select the coarsest alarm mode which matches a target exactly once.
+    ///
+    /// @param[in] delay The delay from now to the target in seconds. For alarm 2,
+    ///     the target has to be at a full minute.
+    /// @param[in] alarm The alarm for the mode.
+    /// @param[out] alarmMode The selected alarm mode.
+    /// @return `true` if there is a matching mode, `false` if the delay is zero or too large.
+    ///
+    static bool selectWakeMode(uint32_t delay, Alarm alarm, AlarmMode &alarmMode);
+
     /// Set the mode for the Int/Sqw pin of the chip.
     ///
     Status setIntPinMode(const IntPinMode mode);
-    
+
+    /// Enable or disable the interrupt of one alarm.
+    ///
+    /// Only the `A1IE` or `A2IE` bit is changed, the rest of the INT/SQW pin
+    /// mode is kept. The alarm flag is still set if the alarm matches.
+    ///
+    /// @param[in] alarm The alarm to change.
+    /// @param[in] enabled `true` to enable the interrupt, `false` to disable it.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status setAlarmInterruptEnabled(Alarm alarm, bool enabled);
+
+    /// Configure all outputs of the chip at once.
+    ///
+    /// The control and status registers are written in a single transfer, without
+    /// reading them first. The oscillator is enabled, and no flag is cleared.
+    ///
+    /// @param[in] profile The new configuration of the outputs.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status setPowerProfile(const PowerProfile &profile);
+
+    /// Configure all outputs of the chip using a preset.
+    ///
+    /// @param[in] preset The preset to use.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status setPowerProfile(PowerPreset preset);
+
+    /// Get the power profile for a preset.
+    ///
+    static PowerProfile getPowerProfile(PowerPreset preset);
+
+    /// The frequency of the 32kHz output in Hz.
+    ///
+    /// Use this value as `ticksPerSecond` for `DS3231Clock`, if the 32kHz pin drives
+    /// a timer counter of the MCU. This gives the MCU a temperature compensated
+    /// timebase, without running its own crystal. See `DS3231PulseCounter`.
+    ///
+    constexpr static const uint32_t c32kHzFrequency = 32768;
+
+    /// Enable or disable the 32kHz output.
+    ///
+    /// The output is an open drain pin, and requires a pull-up resistor. It is
+    /// enabled by default after a power-on reset. The status register is written
+    /// in a single transfer, without clearing any of the flags.
+    ///
+    /// @param[in] enabled `true` to enable the output, `false` to disable it.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status set32kHzOutput(bool enabled);
+
+    /// Check if the 32kHz output is enabled.
+    ///
+    /// @param[out] enabled A variable where the state of the output is stored.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status is32kHzOutputEnabled(bool &enabled);
+
     /// Get the temperature in degrees celsius.
     ///
     /// @param temperature A variable where the read temperature is stored.
@@ -163,6 +459,215 @@ public:
     ///
     Status getTemperature(float &temperature);
 
+    /// Get the temperature in quarter degrees celsius.
+    ///
+    /// This function uses no floating point math. A value of `101` means 25.25°C.
+    ///
+    /// @param quarterDegrees A variable where the read temperature is stored.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status getTemperatureFixed(int16_t &quarterDegrees);
+
+    /// Start a temperature conversion.
+    ///
+    /// The chip converts the temperature every 64 seconds automatically. Use this
+    /// function to get a fresh value. The conversion takes up to 200ms, use
+    /// `isConversionBusy()` to check when the new value is available.
+    /// If a conversion is already in progress, no new conversion is started.
+    ///
+    /// @param[out] isStarted If a new conversion was started.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status triggerTemperatureConversion(bool &isStarted);
+
+    /// Check if a temperature conversion is in progress.
+    ///
+    /// @param[out] isBusy If a forced or automatic conversion is in progress.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status isConversionBusy(bool &isBusy);
+
+    /// Get the aging offset.
+    ///
+    /// The aging offset adjusts the frequency of the oscillator. One step is
+    /// about 0.1ppm at 25°C, positive values slow down the oscillator.
+    ///
+    /// @param[out] offset A variable where the aging offset is stored.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status getAgingOffset(int8_t &offset);
+
+    /// Set the aging offset.
+    ///
+    /// The new offset is applied with the next temperature conversion. Use
+    /// `triggerTemperatureConversion()` to apply the offset immediately.
+    ///
+    /// @param[in] offset The new aging offset.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status setAgingOffset(int8_t offset);
+
+public:
+    /// @name Batch
+    /// Collect multiple register changes and write them with as few transactions as possible.
+    /// @{
+
+    class Batch;
+
+    /// @}
+
+public:
+    /// @name Snapshot
+    /// Read the whole state of the chip in one transaction.
+    /// @{
+
+    struct Snapshot;
+
+    /// Read all registers of the chip in one batch.
+    ///
+    /// Use the accessors of the snapshot to decode the values, without any further
+    /// communication with the chip. In contrast to `isAlarm1Set()` and `isAlarm2Set()`,
+    /// reading a snapshot does not clear the alarm flags.
+    ///
+    /// @param[out] snapshot The snapshot to fill with the register values.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status readSnapshot(Snapshot &snapshot);
+
+    /// @}
+
+public:
+    /// @name Register Cache
+    /// An optional shadow copy of the `Control`, `Status` and `AgingOffset` registers.
+    ///
+    /// If the cache is enabled, configuration changes are written with a single write
+    /// transaction instead of a read-modify-write sequence, and configuration bits are
+    /// read from the shadow copy. The hardware flags `OSF`, `A1F`, `A2F` and `BSY` are
+    /// never cached and are always read from the chip.
+    ///
+    /// The cache assumes this driver is the only one changing these registers. If
+    /// the chip is accessed in another way, call `invalidateCache()` or `syncCache()`.
+    /// @{
+
+    /// Enable or disable the register cache.
+    ///
+    /// The cache is disabled by default. Changing the state invalidates the cache,
+    /// it is filled again with the next access.
+    ///
+    /// @param[in] enabled `true` to enable the cache, `false` to disable it.
+    ///
+    void setCacheEnabled(bool enabled);
+
+    /// Check if the register cache is enabled.
+    ///
+    inline bool isCacheEnabled() const {
+        return _isCacheEnabled;
+    }
+
+    /// Invalidate the register cache.
+    ///
+    /// The next access will read the registers from the chip again.
+    ///
+    inline void invalidateCache() {
+        _isCacheValid = false;
+        _alarmCacheMask = 0;
+    }
+
+    /// Read the cached registers from the chip in one batch.
+    ///
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status syncCache();
+
+    /// @}
+
+public:
+    /// @name Retry Policy
+    /// Retry failed bus calls with a bounded worst case latency.
+    /// @{
+
+    /// A function which waits for the given number of microseconds.
+    ///
+    using DelayFunction = void(*)(uint32_t microseconds);
+
+    /// A function which recovers a stuck bus, e.g. by toggling SCL nine times.
+    ///
+    using RecoveryFunction = void(*)();
+
+    /// The policy to retry failed bus calls.
+    ///
+    /// A failed bus call is repeated up to `maximumAttempts` times in total. Before
+    /// each retry, the bus recovery function is called, and the driver waits for
+    /// the backoff time, which doubles with each retry. The sum of all waits never
+    /// exceeds `backoffBudget`. So the worst case latency of a call is
+    /// `maximumAttempts` transfers, plus the recovery calls, plus the budget.
+    ///
+    struct RetryPolicy {
+        uint8_t maximumAttempts = 1; ///< The maximum number of attempts, `1` disables retries.
+        uint32_t initialBackoff = 0; ///< The wait before the first retry in microseconds.
+        uint32_t backoffBudget = 0; ///< The maximum sum of all waits in microseconds.
+        DelayFunction delay = nullptr; ///< The function to wait, or `nullptr` to retry without waiting.
+        RecoveryFunction recoverBus = nullptr; ///< The function to recover the bus, or `nullptr`.
+    };
+
+    /// Set the retry policy for all bus calls.
+    ///
+    /// By default, failed bus calls are not retried.
+    ///
+    inline void setRetryPolicy(const RetryPolicy &policy) {
+        _retryPolicy = policy;
+    }
+
+    /// Get the retry policy.
+    ///
+    inline const RetryPolicy& getRetryPolicy() const {
+        return _retryPolicy;
+    }
+
+    /// @}
+
+#ifdef LR_DS3231_STATISTICS
+public:
+    /// @name Statistics
+    /// Counters for all bus transactions of this driver.
+    ///
+    /// The statistics are only available if the macro `LR_DS3231_STATISTICS` is
+    /// defined for the whole project.
+    /// @{
+
+    /// The statistics about the bus transactions.
+    ///
+    struct Statistics {
+        uint32_t readCount = 0; ///< The number of read transactions.
+        uint32_t writeCount = 0; ///< The number of write transactions.
+        uint32_t byteCount = 0; ///< The number of bytes on the bus, including address and register bytes.
+        uint32_t errorCount = 0; ///< The number of bus calls which returned an error, including retries.
+        uint32_t retryCount = 0; ///< The number of retried bus calls.
+        uint32_t recoveryCount = 0; ///< The number of calls of the bus recovery function.
+        uint32_t busTime = 0; ///< The time spent in bus calls, in ticks of the statistics timer.
+    };
+
+    /// Get the collected statistics.
+    ///
+    inline const Statistics& getStatistics() const {
+        return _statistics;
+    }
+
+    /// Reset all statistics counters.
+    ///
+    void resetStatistics();
+
+    /// Set the timer used to measure the time spent in bus calls.
+    ///
+    /// @param[in] timer A tick function, e.g. returning microseconds. Use `nullptr` to disable the time measurement.
+    ///
+    inline void setStatisticsTimer(TickFunction timer) {
+        _statisticsTimer = timer;
+    }
+
+    /// @}
+#endif
+
 public:
     /// @name Low Level Functions
     /// Low level functions to directly access all registers of the chip or
@@ -176,6 +681,47 @@ public:
     ///
     Status getAllRegisterValuesAsString(String &str);
 
+    /// A function receiving the characters of a text dump.
+    ///
+    /// @param c The next character.
+    /// @param context The context which was passed to the dump function.
+    ///
+    using CharacterSink = void(*)(char c, void *context);
+
+    /// The buffer size required for `writeAllRegisterValues()`, including the terminating zero.
+    ///
+    /// There is one line like `0e:1c:00011100` for each register.
+    ///
+    constexpr static const uint16_t cRegisterDumpTextSize = 0x13*15+1;
+
+    /// Write all register values as text into a character sink.
+    ///
+    /// This function uses no dynamic memory. There is one line for each register,
+    /// with the register address and value in hex, followed by the value in binary.
+    ///
+    /// @param sink The function receiving the characters.
+    /// @param context A pointer which is passed to the sink.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status writeAllRegisterValues(CharacterSink sink, void *context = nullptr);
+
+    /// Write all register values as text into a buffer.
+    ///
+    /// @see writeAllRegisterValues(CharacterSink, void*)
+    /// @param buffer The buffer, which should have `cRegisterDumpTextSize` bytes.
+    ///     The text is always zero terminated and cut if the buffer is too small.
+    /// @param size The size of the buffer.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status writeAllRegisterValues(char *buffer, uint16_t size);
+
+    /// Read all register values in binary form.
+    ///
+    /// @param buffer A buffer for `getRegisterCount()` bytes.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status readRegisterDump(uint8_t *buffer);
+
     /// All registers available in the chip.
     ///
     enum class Register : uint8_t {
@@ -253,13 +799,226 @@ private:
     struct DateTimeRegister;
     struct AlarmRegister;
     struct TemperatureRegister;
+
+    /// @internal
+    /// The shadow copy of the `Control`, `Status` and `AgingOffset` registers.
+    ///
+    struct RegisterCache {
+        uint8_t control; ///< The control register, the `CONV` bit is never stored.
+        uint8_t status; ///< The writable bits of the status register.
+        uint8_t agingOffset; ///< The aging offset register.
+    };
+
+    /// The number of registers compared by `begin()`, from `Alarm1Seconds` to `Status`.
+    ///
+    constexpr static const uint8_t cConfigRegisterCount = 9;
+
+    /// The index of the control register in the registers compared by `begin()`.
+    ///
+    constexpr static const uint8_t cConfigControlIndex = 7;
+
+    /// The index of the status register in the registers compared by `begin()`.
+    ///
+    constexpr static const uint8_t cConfigStatusIndex = 8;
+
+    /// The writable configuration bits in the status register.
+    ///
+    constexpr static const uint8_t cStatusWritableMask = static_cast<uint8_t>(StatusFlag::EN32kHz);
+
+    /// The flags in the status register which can only be cleared.
+    ///
+    constexpr static const uint8_t cStatusClearableMask =
+        static_cast<uint8_t>(StatusFlag::A1F)|static_cast<uint8_t>(StatusFlag::A2F)|static_cast<uint8_t>(StatusFlag::OSF);
     
 private:
+    static DateTime decodeDateTime(const DateTimeRegister &data, uint16_t yearBase);
+    static bool decodeUnixTime(const DateTimeRegister &data, uint16_t yearBase, uint32_t &unixTime);
+    bool encodeUnixTime(uint32_t unixTime, DateTimeRegister &data) const;
+    static float decodeTemperature(const TemperatureRegister &data);
+    static int16_t decodeTemperatureFixed(const TemperatureRegister &data);
+    Status readControlAndStatus(uint8_t (&data)[2]);
+    bool encodeDateTime(const DateTime &dateTime, DateTimeRegister &data) const;
     void fillAlarmRegister(const AlarmMode alarmMode, const lr::DateTime &dateTime, AlarmRegister &data);
+    static bool decodeAlarmRegister(const AlarmRegister &data, Alarm alarm, uint16_t yearBase,
+        AlarmMode &alarmMode, DateTime &dateTime);
+    Status readAlarmRegister(Alarm alarm, AlarmRegister &data);
+    Status writeAlarmRegister(Alarm alarm, AlarmRegister &data);
+    void storeAlarmCache(Alarm alarm, const AlarmRegister &data);
+    Status getAlarm(Alarm alarm, AlarmMode &alarmMode, DateTime &dateTime);
+    static uint8_t encodeControl(const PowerProfile &profile);
+    static uint8_t encodeStatus(const PowerProfile &profile);
+    Status programWake(uint32_t now, uint32_t target, Alarm alarm);
+    bool isCacheReady();
+    Status updateIncremental();
+    WireMaster::Status busRead(Register reg, uint8_t *data, uint8_t count);
+    WireMaster::Status busWrite(Register reg, uint8_t *data, uint8_t count);
+    WireMaster::Status busWriteOnce(Register reg, uint8_t *data, uint8_t count);
+    WireMaster::Status busWriteBits(Register reg, uint8_t mask, uint8_t bits);
+    WireMaster::Status busChangeBits(Register reg, uint8_t mask, WireMaster::BitOperation operation);
+    WireMaster::Status busTestBits(Register reg, uint8_t mask, WireMaster::BitResult &result);
+    template<typename tFunction>
+    WireMaster::Status withRetry(tFunction function);
+    uint32_t statisticsStart() const;
+    void statisticsRetry(bool isRecovered);
+    void statisticsRecord(WireMaster::Status status, uint8_t reads, uint8_t writes, uint8_t bytes, uint32_t startTime);
+    Status writeControlBits(uint8_t mask, uint8_t bits);
+    Status clearStatusFlags(uint8_t flags);
     
 private:
     const WireMasterRegisterChip<Register> _bus; ///< The bus for the communication.
     const uint16_t _yearBase; ///< The base for the year.
+    bool _isCacheEnabled; ///< If the register cache is enabled.
+    bool _isCacheValid; ///< If the register cache contains valid data.
+    RegisterCache _cache; ///< The register cache.
+    uint8_t _alarmCache[7]; ///< The cached alarm registers `Alarm1Seconds` to `Alarm2Day`.
+    uint8_t _alarmCacheMask; ///< Bit 0 and 1 are set if alarm 1 and 2 are cached.
+    TickFunction _incrementalTimer; ///< The timer for incremental reads, or `nullptr`.
+    bool _isIncrementalValid; ///< If the values for incremental reads are valid.
+    uint32_t _incrementalTick; ///< The timer value of the last read.
+    int64_t _incrementalMinuteTime; ///< The last read minute in seconds since 1970-01-01.
+    CivilTime::Fields _incrementalFields; ///< The last read date/time.
+    RetryPolicy _retryPolicy; ///< The policy to retry failed bus calls.
+#ifdef LR_DS3231_STATISTICS
+    Statistics _statistics; ///< The bus statistics.
+    TickFunction _statisticsTimer; ///< The timer for the bus time statistics.
+#endif
+};
+
+
+/// A batch of register changes.
+///
+/// All changes are collected in the batch and written with `commit()`. Changes of
+/// registers which are in sequence are merged into one write transaction. If all
+/// of date/time, both alarms and the INT pin mode are set, the whole batch is
+/// written in one burst of 15 bytes.
+///
+/// ```
+/// DS3231::Batch batch(&rtc);
+/// batch.setDateTime(dateTime);
+/// batch.setAlarm1(DS3231::AlarmMode::HoursMinutesSeconds, alarmTime);
+/// batch.setIntPinMode(DS3231::IntPinMode::Alarm1);
+/// batch.commit();
+/// ```
+///
+class DS3231::Batch
+{
+public:
+    /// Create a new empty batch.
+    ///
+    /// @param[in] rtc The driver used to write the changes.
+    ///
+    explicit Batch(DS3231 *rtc);
+
+public:
+    /// Set the date/time.
+    ///
+    /// @see DS3231::setDateTime()
+    /// @return `Success` or `Error` if the date is outside of the valid range.
+    ///
+    Status setDateTime(const DateTime &dateTime);
+
+    /// Set the first alarm.
+    ///
+    /// @see DS3231::setAlarm1()
+    ///
+    void setAlarm1(const AlarmMode alarmMode, const DateTime &dateTime = DateTime());
+
+    /// Set the second alarm.
+    ///
+    /// @see DS3231::setAlarm2()
+    ///
+    void setAlarm2(const AlarmMode alarmMode, const DateTime &dateTime = DateTime());
+
+    /// Set the mode for the Int/Sqw pin of the chip.
+    ///
+    /// @see DS3231::setIntPinMode()
+    ///
+    void setIntPinMode(const IntPinMode mode);
+
+    /// Check if this batch contains no changes.
+    ///
+    inline bool isEmpty() const {
+        return _dirtyMask == 0 && _controlMask == 0;
+    }
+
+    /// Remove all changes from this batch.
+    ///
+    void clear();
+
+    /// Write all changes to the chip.
+    ///
+    /// If the INT pin mode is changed, the control register is read first, unless
+    /// the register cache of the driver is enabled. After a successful commit, the
+    /// batch is empty.
+    ///
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status commit();
+
+private:
+    /// The number of registers which can be changed by a batch.
+    ///
+    constexpr static const uint8_t cRegisterCount = static_cast<uint8_t>(Register::Control) + 1;
+
+private:
+    void setRegisters(Register first, const uint8_t *data, uint8_t count);
+
+private:
+    DS3231 *_rtc; ///< The driver used to write the changes.
+    uint8_t _data[cRegisterCount]; ///< The new register values.
+    uint16_t _dirtyMask; ///< One bit for each changed register.
+    uint8_t _controlMask; ///< The changed bits in the control register.
+    uint8_t _controlBits; ///< The new bits for the control register.
+};
+
+
+/// A snapshot of all registers of the chip.
+///
+/// The snapshot is filled using `DS3231::readSnapshot()`.
+///
+struct DS3231::Snapshot
+{
+    /// Get the date/time stored in this snapshot.
+    ///
+    DateTime getDateTime() const;
+
+    /// Get the time stored in this snapshot as seconds since 1970-01-01.
+    ///
+    /// @param[out] unixTime The variable where the time is stored.
+    /// @return `true` on success, `false` if the time is after 2106-02-07 06:28:15.
+    ///
+    bool getUnixTime(uint32_t &unixTime) const;
+
+    /// Check if the RTC was running.
+    ///
+    /// @see DS3231::isRunning()
+    ///
+    bool isRunning() const;
+
+    /// Check if the flag for alarm 1 was set.
+    ///
+    bool isAlarm1Set() const;
+
+    /// Check if the flag for alarm 2 was set.
+    ///
+    bool isAlarm2Set() const;
+
+    /// Get the temperature in degrees celsius.
+    ///
+    float getTemperature() const;
+
+    /// Get the temperature in quarter degrees celsius.
+    ///
+    int16_t getTemperatureFixed() const;
+
+    /// Get the raw value of a register.
+    ///
+    inline uint8_t getRegister(Register reg) const {
+        return registers[static_cast<uint8_t>(reg)];
+    }
+
+    uint8_t registers[DS3231::getRegisterCount()] = {}; ///< The raw register values.
+    uint16_t yearBase = 2000; ///< The year base of the driver which read the snapshot.
 };
 
 
@@ -0,0 +1,62 @@
+//
+// Interrupt driven alarm dispatcher for the DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DS3231AlarmDispatcher.hpp"
+
+
+namespace lr {
+
+
+DS3231AlarmDispatcher::DS3231AlarmDispatcher(DS3231 *rtc)
+    : _rtc(rtc), _alarm1Handler(nullptr), _alarm2Handler(nullptr), _isPending(false)
+{
+}
+
+
+DS3231AlarmDispatcher::Status DS3231AlarmDispatcher::process()
+{
+    if (!_isPending) {
+        return Status::Success;
+    }
+    _isPending = false;
+    // The INT pin stays low while a flag is set. A flag which is set after the status
+    // read is not cleared and causes no new edge, so read again until no flag is set.
+    while (true) {
+        bool isAlarm1Set;
+        bool isAlarm2Set;
+        const auto status = _rtc->readAndClearAlarms(isAlarm1Set, isAlarm2Set);
+        if (hasError(status)) {
+            _isPending = true;
+            return status;
+        }
+        if (!isAlarm1Set && !isAlarm2Set) {
+            return Status::Success;
+        }
+        if (isAlarm1Set && _alarm1Handler != nullptr) {
+            _alarm1Handler();
+        }
+        if (isAlarm2Set && _alarm2Handler != nullptr) {
+            _alarm2Handler();
+        }
+    }
+}
+
+
+}
+
@@ -0,0 +1,107 @@
+#pragma once
+//
+// Interrupt driven alarm dispatcher for the DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "DS3231.hpp"
+
+
+namespace lr {
+
+
+/// Dispatch the alarms of the chip, driven by the INT pin.
+///
+/// Configure the INT/SQW pin with `IntPinMode::Alarm1`, `Alarm2` or `Alarm12`
+/// and call `onIntPinFalling()` from the interrupt handler of the pin. The next
+/// call of `process()` from the main loop reads the status register, clears all
+/// set alarm flags with a single write and calls the registered handlers. Then
+/// the status register is read again, until no alarm flag is set, so an alarm
+/// which fires meanwhile is not lost. As long as no alarm fires, the bus is not
+/// accessed at all.
+///
+class DS3231AlarmDispatcher
+{
+public:
+    /// The status of function calls
+    ///
+    using Status = DS3231::Status;
+
+    /// A handler which is called if an alarm fired.
+    ///
+    using Handler = void(*)();
+
+public:
+    /// Create a new alarm dispatcher.
+    ///
+    /// @param[in] rtc The RTC driver to use.
+    ///
+    explicit DS3231AlarmDispatcher(DS3231 *rtc);
+
+public:
+    /// Set the handler for alarm 1.
+    ///
+    /// @param[in] handler The handler, or `nullptr` to remove the handler.
+    ///
+    inline void setAlarm1Handler(Handler handler) {
+        _alarm1Handler = handler;
+    }
+
+    /// Set the handler for alarm 2.
+    ///
+    /// @param[in] handler The handler, or `nullptr` to remove the handler.
+    ///
+    inline void setAlarm2Handler(Handler handler) {
+        _alarm2Handler = handler;
+    }
+
+    /// Notify the dispatcher about a falling edge of the INT pin.
+    ///
+    /// Call this method from the interrupt handler. It never accesses the bus.
+    ///
+    inline void onIntPinFalling() {
+        _isPending = true;
+    }
+
+    /// Check if there is an interrupt which was not processed yet.
+    ///
+    inline bool isPending() const {
+        return _isPending;
+    }
+
+    /// Process a pending interrupt and call the handlers.
+    ///
+    /// Call this method from the main loop. If there is no pending interrupt,
+    /// the method returns immediately. On a communication error, the interrupt
+    /// stays pending and is processed again with the next call.
+    ///
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status process();
+
+private:
+    DS3231 *_rtc; ///< The RTC driver.
+    Handler _alarm1Handler; ///< The handler for alarm 1.
+    Handler _alarm2Handler; ///< The handler for alarm 2.
+    volatile bool _isPending; ///< If there is an unprocessed interrupt.
+};
+
+
+}
+
@@ -0,0 +1,151 @@
+//
+// Redundant DS3231 chips behind an I2C multiplexer
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DS3231Array.hpp"
+
+
+namespace lr {
+
+
+DS3231Array::DS3231Array(WireMaster *bus, uint8_t multiplexerAddress)
+    : _bus(bus), _multiplexerAddress(multiplexerAddress), _devices(), _count(0), _selectedChannel(cNoChannel),
+    _quorum(cDefaultQuorum)
+{
+}
+
+
+DS3231Array::Status DS3231Array::addDevice(DS3231 *rtc, uint8_t channel)
+{
+    if (_count >= cMaximumDeviceCount || channel >= 8 || rtc == nullptr) {
+        return Status::Error;
+    }
+    _devices[_count].rtc = rtc;
+    _devices[_count].channel = channel;
+    ++_count;
+    return Status::Success;
+}
+
+
+DS3231Array::Status DS3231Array::selectChannel(uint8_t channel)
+{
+    if (channel == _selectedChannel) {
+        return Status::Success;
+    }
+    // The multiplexer has a single control register, written without a register address.
+    const uint8_t channelMask = static_cast<uint8_t>(1u << channel);
+    const auto status = _bus->writeBytes(_multiplexerAddress, &channelMask, 1);
+    if (hasError(status)) {
+        _selectedChannel = cNoChannel;
+        return Status::Error;
+    }
+    _selectedChannel = channel;
+    return Status::Success;
+}
+
+
+DS3231Array::Status DS3231Array::select(uint8_t index, DS3231 *&rtc)
+{
+    if (index >= _count) {
+        return Status::Error;
+    }
+    const auto status = selectChannel(_devices[index].channel);
+    if (hasError(status)) {
+        return status;
+    }
+    rtc = _devices[index].rtc;
+    return Status::Success;
+}
+
+
+DS3231Array::Status DS3231Array::readUnixTimes(uint32_t *times, uint8_t &validMask)
+{
+    validMask = 0;
+    if (_count == 0) {
+        return Status::Error;
+    }
+    // Start with the chip on the selected channel, to save one switch.
+    uint8_t start = 0;
+    for (uint8_t i = 0; i < _count; ++i) {
+        if (_devices[i].channel == _selectedChannel) {
+            start = i;
+            break;
+        }
+    }
+    for (uint8_t i = 0; i < _count; ++i) {
+        const uint8_t index = static_cast<uint8_t>((start + i) % _count);
+        if (hasError(selectChannel(_devices[index].channel))) {
+            continue;
+        }
+        if (isSuccessful(_devices[index].rtc->getUnixTime(times[index]))) {
+            validMask |= static_cast<uint8_t>(1u << index);
+        }
+    }
+    return (validMask != 0) ? Status::Success : Status::Error;
+}
+
+
+DS3231Array::Status DS3231Array::getReconciledTime(uint32_t &unixTime, uint8_t &outlierMask, uint32_t tolerance)
+{
+    uint32_t times[cMaximumDeviceCount];
+    uint8_t validMask;
+    outlierMask = static_cast<uint8_t>((1u << _count) - 1u);
+    const auto status = readUnixTimes(times, validMask);
+    if (hasError(status)) {
+        return status;
+    }
+    // Find the time with the most agreeing chips.
+    uint8_t bestIndex = 0;
+    uint8_t bestVotes = 0;
+    uint8_t bestMask = 0;
+    uint8_t validCount = 0;
+    for (uint8_t i = 0; i < _count; ++i) {
+        if ((validMask & (1u << i)) == 0) {
+            continue;
+        }
+        ++validCount;
+        uint8_t votes = 0;
+        uint8_t mask = 0;
+        for (uint8_t j = 0; j < _count; ++j) {
+            if ((validMask & (1u << j)) == 0) {
+                continue;
+            }
+            const uint32_t difference = (times[i] > times[j]) ? (times[i] - times[j]) : (times[j] - times[i]);
+            if (difference <= tolerance) {
+                ++votes;
+                mask |= static_cast<uint8_t>(1u << j);
+            }
+        }
+        if (votes > bestVotes) {
+            bestIndex = i;
+            bestVotes = votes;
+            bestMask = mask;
+        }
+    }
+    outlierMask = static_cast<uint8_t>(outlierMask & ~bestMask);
+    // The majority is counted over the chips which could be read.
+    if (bestVotes * 2 <= validCount || bestVotes < _quorum) {
+        return Status::Error;
+    }
+    unixTime = times[bestIndex];
+    return Status::Success;
+}
+
+
+}
+
@@ -0,0 +1,159 @@
+#pragma once
+//
+// Redundant DS3231 chips behind an I2C multiplexer
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "DS3231.hpp"
+
+
+namespace lr {
+
+
+/// Multiple DS3231 chips behind a TCA9548A I2C multiplexer.
+///
+/// All chips use the same address, so each one is connected to its own
+/// channel of the multiplexer. The array keeps track of the selected channel
+/// and only switches the multiplexer if a chip on another channel is accessed.
+/// Reading all chips always starts with the chip on the selected channel, so a
+/// read of `n` chips needs `n-1` channel switches at most.
+///
+/// The drivers are owned by the caller, they have to use the same bus as the array.
+///
+class DS3231Array
+{
+public:
+    /// The status of function calls
+    ///
+    using Status = DS3231::Status;
+
+    /// The maximum number of chips, one per multiplexer channel.
+    ///
+    constexpr static const uint8_t cMaximumDeviceCount = 8;
+
+    /// The default address of the multiplexer.
+    ///
+    constexpr static const uint8_t cMultiplexerAddress = 0x70;
+
+    /// The default tolerance in seconds for the time reconciliation.
+    ///
+    constexpr static const uint32_t cDefaultTolerance = 1;
+
+    /// The default minimum number of agreeing chips for the time reconciliation.
+    ///
+    constexpr static const uint8_t cDefaultQuorum = 1;
+
+public:
+    /// Create a new empty array.
+    ///
+    /// @param[in] bus The bus where the multiplexer is connected.
+    /// @param[in] multiplexerAddress The address of the multiplexer.
+    ///
+    explicit DS3231Array(WireMaster *bus, uint8_t multiplexerAddress = cMultiplexerAddress);
+
+public:
+    /// Add a chip to the array.
+    ///
+    /// @param[in] rtc The driver for the chip.
+    /// @param[in] channel The multiplexer channel 0-7 of the chip.
+    /// @return `Success` or `Error` if the array is full or the channel is invalid.
+    ///
+    Status addDevice(DS3231 *rtc, uint8_t channel);
+
+    /// Get the number of chips in the array.
+    ///
+    inline uint8_t getDeviceCount() const {
+        return _count;
+    }
+
+    /// Select the channel of a chip and get its driver.
+    ///
+    /// @param[in] index The index of the chip.
+    /// @param[out] rtc The driver of the chip, which can be used until another chip is selected.
+    /// @return `Success` or `Error` if there was a communication problem with the multiplexer.
+    ///
+    Status select(uint8_t index, DS3231 *&rtc);
+
+    /// Forget the selected channel.
+    ///
+    /// Call this method if the multiplexer was switched outside of this array.
+    ///
+    inline void invalidateChannel() {
+        _selectedChannel = cNoChannel;
+    }
+
+    /// Read the time of all chips.
+    ///
+    /// @param[out] times An array for `getDeviceCount()` times, in order of the chips.
+    /// @param[out] validMask One bit for each chip, set if the time was read successfully.
+    /// @return `Success` or `Error` if no chip could be read.
+    ///
+    Status readUnixTimes(uint32_t *times, uint8_t &validMask);
+
+    /// Set the minimum number of agreeing chips for `getReconciledTime()`.
+    ///
+    /// @param[in] quorum The minimum number of chips, which have to agree on the time.
+    ///
+    inline void setQuorum(uint8_t quorum) {
+        _quorum = quorum;
+    }
+
+    /// Get the time agreed on by the majority of the chips.
+    ///
+    /// The majority is counted over the chips which could be read, so a chip
+    /// without response is no vote against the others. At least the number of
+    /// chips set with `setQuorum()` have to agree, e.g. set it to `2` to never
+    /// trust the time of a single chip.
+    ///
+    /// @param[out] unixTime The reconciled time in seconds since 1970-01-01.
+    /// @param[out] outlierMask One bit for each chip, set if the chip could not be read
+    ///     or its time does not agree with the majority.
+    /// @param[in] tolerance The maximum difference in seconds for agreeing times.
+    /// @return `Success` or `Error` if there is no majority of the read chips, or
+    ///     less chips than the quorum agree.
+    ///
+    Status getReconciledTime(uint32_t &unixTime, uint8_t &outlierMask, uint32_t tolerance = cDefaultTolerance);
+
+private:
+    /// The value for an unknown multiplexer channel.
+    ///
+    constexpr static const uint8_t cNoChannel = 0xff;
+
+    /// One chip in the array.
+    ///
+    struct Device {
+        DS3231 *rtc; ///< The driver of the chip.
+        uint8_t channel; ///< The multiplexer channel.
+    };
+
+private:
+    Status selectChannel(uint8_t channel);
+
+private:
+    WireMaster *_bus; ///< The bus where the multiplexer is connected.
+    const uint8_t _multiplexerAddress; ///< The address of the multiplexer.
+    Device _devices[cMaximumDeviceCount]; ///< The chips in the array.
+    uint8_t _count; ///< The number of chips.
+    uint8_t _selectedChannel; ///< The selected channel or `cNoChannel`.
+    uint8_t _quorum; ///< The minimum number of agreeing chips.
+};
+
+
+}
+
@@ -0,0 +1,96 @@
+//
+// Deferred requests for the DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DS3231Async.hpp"
+
+
+namespace lr {
+
+
+DS3231Async::DS3231Async(DS3231 *rtc)
+    : _rtc(rtc), _queue(), _head(0), _count(0)
+{
+}
+
+
+DS3231Async::Status DS3231Async::getDateTimeAsync(DateTime &dateTime, Callback callback, void *context)
+{
+    return enqueue(Type::DateTime, &dateTime, callback, context);
+}
+
+
+DS3231Async::Status DS3231Async::getTemperatureAsync(float &temperature, Callback callback, void *context)
+{
+    return enqueue(Type::Temperature, &temperature, callback, context);
+}
+
+
+DS3231Async::Status DS3231Async::readSnapshotAsync(DS3231::Snapshot &snapshot, Callback callback, void *context)
+{
+    return enqueue(Type::Snapshot, &snapshot, callback, context);
+}
+
+
+DS3231Async::Status DS3231Async::enqueue(Type type, void *target, Callback callback, void *context)
+{
+    if (_count >= cQueueSize) {
+        return Status::Error; // The queue is full.
+    }
+    auto &request = _queue[(_head + _count) % cQueueSize];
+    request.type = type;
+    request.target = target;
+    request.callback = callback;
+    request.context = context;
+    ++_count;
+    return Status::Success;
+}
+
+
+void DS3231Async::poll()
+{
+    if (_count == 0) {
+        return;
+    }
+    // Remove the request first, so the callback can queue new requests.
+    const Request request = _queue[_head];
+    _head = static_cast<uint8_t>((_head + 1) % cQueueSize);
+    --_count;
+    Status status;
+    switch (request.type) {
+    case Type::DateTime:
+        status = _rtc->getDateTime(*static_cast<DateTime*>(request.target));
+        break;
+    case Type::Temperature:
+        status = _rtc->getTemperature(*static_cast<float*>(request.target));
+        break;
+    case Type::Snapshot:
+        status = _rtc->readSnapshot(*static_cast<DS3231::Snapshot*>(request.target));
+        break;
+    default:
+        status = Status::Error;
+        break;
+    }
+    if (request.callback != nullptr) {
+        request.callback(status, request.context);
+    }
+}
+
+
+}
+
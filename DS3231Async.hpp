@@ -0,0 +1,135 @@
+#pragma once
+//
+// Deferred requests for the DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "DS3231.hpp"
+
+
+namespace lr {
+
+
+/// Deferred requests for the DS3231 driver.
+///
+/// Nothing in this class is asynchronous on the bus. The `WireMaster` interface
+/// only provides blocking transfers, so `poll()` blocks for the duration of one
+/// transfer. This class only defers the queued read requests, and executes them
+/// from `poll()`, one transfer per call. This moves the bus traffic out of time
+/// critical code, into a place the application chooses, e.g. the idle part of
+/// the main loop.
+///
+/// The target variables have to stay valid until the callback is called.
+///
+class DS3231Async
+{
+public:
+    /// The status of function calls
+    ///
+    using Status = DS3231::Status;
+
+    /// The callback which is called after a request was executed.
+    ///
+    /// @param status `Success` or `Error` if there was a communication problem with the chip.
+    /// @param context The context which was passed with the request.
+    ///
+    using Callback = void(*)(Status status, void *context);
+
+    /// The maximum number of queued requests.
+    ///
+    constexpr static const uint8_t cQueueSize = 4;
+
+public:
+    /// Create a new request queue.
+    ///
+    /// @param[in] rtc The RTC driver to use.
+    ///
+    explicit DS3231Async(DS3231 *rtc);
+
+public:
+    /// Queue a request to read the current date/time.
+    ///
+    /// @param[out] dateTime The variable where the read date/time is stored.
+    /// @param[in] callback The callback which is called after the request was executed.
+    /// @param[in] context A pointer which is passed to the callback.
+    /// @return `Success` or `Error` if the queue is full.
+    ///
+    Status getDateTimeAsync(DateTime &dateTime, Callback callback, void *context = nullptr);
+
+    /// Queue a request to read the temperature.
+    ///
+    /// @param[out] temperature The variable where the read temperature is stored.
+    /// @param[in] callback The callback which is called after the request was executed.
+    /// @param[in] context A pointer which is passed to the callback.
+    /// @return `Success` or `Error` if the queue is full.
+    ///
+    Status getTemperatureAsync(float &temperature, Callback callback, void *context = nullptr);
+
+    /// Queue a request to read a snapshot of all registers.
+    ///
+    /// @param[out] snapshot The snapshot to fill.
+    /// @param[in] callback The callback which is called after the request was executed.
+    /// @param[in] context A pointer which is passed to the callback.
+    /// @return `Success` or `Error` if the queue is full.
+    ///
+    Status readSnapshotAsync(DS3231::Snapshot &snapshot, Callback callback, void *context = nullptr);
+
+    /// Check if there are pending requests.
+    ///
+    inline bool hasPendingRequests() const {
+        return _count > 0;
+    }
+
+    /// Execute the next pending request.
+    ///
+    /// This method executes at most one blocking transfer and calls the callback of the request.
+    ///
+    void poll();
+
+private:
+    /// The type of a request.
+    ///
+    enum class Type : uint8_t {
+        DateTime,
+        Temperature,
+        Snapshot
+    };
+
+    /// A queued request.
+    ///
+    struct Request {
+        Type type; ///< The type of the request.
+        void *target; ///< The variable where the result is stored.
+        Callback callback; ///< The callback to call.
+        void *context; ///< The context for the callback.
+    };
+
+private:
+    Status enqueue(Type type, void *target, Callback callback, void *context);
+
+private:
+    DS3231 *_rtc; ///< The RTC driver.
+    Request _queue[cQueueSize]; ///< The ring buffer with the requests.
+    uint8_t _head; ///< The index of the next request to execute.
+    uint8_t _count; ///< The number of queued requests.
+};
+
+
+}
+
@@ -0,0 +1,84 @@
+#pragma once
+//
+// BCD conversions for the DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// BCD conversions used for the DS3231 registers.
+///
+/// The conversion from binary to BCD uses a lookup table instead of a division
+/// by ten. The conversion from BCD to binary only needs a shift and a
+/// multiplication with a constant. The `HAL-ds3231-bcd` benchmark compares the
+/// table with the division. On a host, the compiler replaces the division by
+/// a multiplication and the table is not faster, so measure on the target.
+///
+namespace DS3231Bcd {
+
+
+/// @internal
+/// The lookup table for the binary to BCD conversion.
+///
+inline constexpr uint8_t cBinToBcdTable[100] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+    0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+    0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79,
+    0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99,
+};
+
+
+/// Convert a binary value in the range 0-99 into BCD.
+///
+/// Values above 99 are reduced modulo 100, so the table is never read out
+/// of bounds, e.g. for an unchecked `DateTime`.
+///
+/// @param value The binary value, which should be in the range 0-99.
+/// @return The value in BCD format.
+///
+constexpr inline uint8_t convertBinToBcd(uint8_t value)
+{
+    return cBinToBcdTable[value < 100 ? value : value % 100];
+}
+
+
+/// Convert a BCD value into binary.
+///
+/// @param value The value in BCD format.
+/// @return The binary value.
+///
+constexpr inline uint8_t convertBcdToBin(uint8_t value)
+{
+    return static_cast<uint8_t>((value >> 4) * 10u + (value & 0x0fu));
+}
+
+
+}
+}
+
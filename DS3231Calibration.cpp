@@ -0,0 +1,146 @@
+//
+// Aging offset calibration for the DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DS3231Calibration.hpp"
+
+
+#include "LinearFit.hpp"
+
+
+namespace lr {
+
+
+DS3231Calibration::DS3231Calibration(DS3231 *rtc)
+    : _rtc(rtc), _samples(), _first(0), _count(0), _firstReferenceTime(0), _firstError(0),
+    _firstTemperature(0)
+{
+}
+
+
+void DS3231Calibration::reset()
+{
+    _first = 0;
+    _count = 0;
+}
+
+
+DS3231Calibration::Status DS3231Calibration::addSample(uint64_t referenceTimeMs, uint64_t rtcTimeMs, bool &isAccepted)
+{
+    isAccepted = false;
+    int16_t temperature;
+    const auto status = _rtc->getTemperatureFixed(temperature);
+    if (hasError(status)) {
+        return status;
+    }
+    // Store all values relative to the first sample, to keep them small.
+    const int64_t error = static_cast<int64_t>(rtcTimeMs - referenceTimeMs);
+    if (_count == 0) {
+        _firstReferenceTime = referenceTimeMs;
+        _firstError = error;
+        _firstTemperature = temperature;
+    } else {
+        const int16_t delta = static_cast<int16_t>(temperature - _firstTemperature);
+        if (delta > cMaximumTemperatureDelta || delta < -cMaximumTemperatureDelta) {
+            return Status::Success; // The drift at this temperature differs too much.
+        }
+    }
+    Sample &sample = _samples[(_first + _count) % cSampleCount];
+    if (_count < cSampleCount) {
+        ++_count;
+    } else {
+        _first = static_cast<uint8_t>((_first + 1) % cSampleCount);
+    }
+    sample.referenceTime = static_cast<uint32_t>((referenceTimeMs - _firstReferenceTime) / 1000u);
+    sample.error = static_cast<int32_t>(error - _firstError);
+    sample.temperature = temperature;
+    isAccepted = true;
+    return Status::Success;
+}
+
+
+const DS3231Calibration::Sample& DS3231Calibration::getSample(uint8_t index) const
+{
+    return _samples[(_first + index) % cSampleCount];
+}
+
+
+bool DS3231Calibration::getDrift(int32_t &drift) const
+{
+    int64_t x[cSampleCount];
+    int64_t y[cSampleCount];
+    for (uint8_t i = 0; i < _count; ++i) {
+        const Sample &sample = getSample(i);
+        x[i] = sample.referenceTime;
+        y[i] = sample.error;
+    }
+    // The slope is in milliseconds per second, scale it to parts per billion.
+    int64_t slope;
+    if (!LinearFit::getSlope(x, y, _count, 1000000, slope)) {
+        return false;
+    }
+    drift = static_cast<int32_t>(slope);
+    return true;
+}
+
+
+DS3231Calibration::Status DS3231Calibration::computeOffset(int8_t &offset)
+{
+    int32_t drift;
+    if (!getDrift(drift)) {
+        return Status::Error;
+    }
+    int8_t currentOffset;
+    const auto status = _rtc->getAgingOffset(currentOffset);
+    if (hasError(status)) {
+        return status;
+    }
+    // A positive offset slows down the oscillator, so a fast RTC needs a larger offset.
+    const int32_t steps = (drift >= 0) ?
+        (drift + cDriftPerOffsetStep / 2) / cDriftPerOffsetStep :
+        (drift - cDriftPerOffsetStep / 2) / cDriftPerOffsetStep;
+    int32_t newOffset = currentOffset + steps;
+    if (newOffset > INT8_MAX) {
+        newOffset = INT8_MAX;
+    } else if (newOffset < INT8_MIN) {
+        newOffset = INT8_MIN;
+    }
+    offset = static_cast<int8_t>(newOffset);
+    return Status::Success;
+}
+
+
+DS3231Calibration::Status DS3231Calibration::apply()
+{
+    int8_t offset;
+    auto status = computeOffset(offset);
+    if (hasError(status)) {
+        return status;
+    }
+    status = _rtc->setAgingOffset(offset);
+    if (hasError(status)) {
+        return status;
+    }
+    reset();
+    bool isStarted;
+    return _rtc->triggerTemperatureConversion(isStarted);
+}
+
+
+}
+
@@ -0,0 +1,145 @@
+#pragma once
+//
+// Aging offset calibration for the DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "DS3231.hpp"
+
+
+namespace lr {
+
+
+/// Calibrate the aging offset of the chip using an external time reference.
+///
+/// Add samples with the time of an external reference, like a GPS PPS signal
+/// or NTP, and the time of the RTC at the same moment. The calibration stores
+/// the error of the RTC and the chip temperature for each sample, and fits the
+/// drift of the RTC over all samples. From the drift, the optimal aging offset
+/// is calculated and applied.
+///
+/// The aging offset only corrects the drift at a constant temperature. Samples
+/// measured at a temperature too far from the first sample are rejected, so the
+/// temperature dependency of the crystal does not end up in the fitted drift.
+///
+/// To get meaningful results, the RTC time needs sub second resolution, e.g.
+/// from a phase aligned `DS3231Clock`, and the samples should span several days.
+///
+class DS3231Calibration
+{
+public:
+    /// The status of function calls
+    ///
+    using Status = DS3231::Status;
+
+    /// The maximum number of stored samples.
+    ///
+    constexpr static const uint8_t cSampleCount = 16;
+
+    /// The drift in parts per billion for one step of the aging offset.
+    ///
+    constexpr static const int32_t cDriftPerOffsetStep = 100;
+
+    /// The maximum difference to the temperature of the first sample, in quarter degrees celsius.
+    ///
+    constexpr static const int16_t cMaximumTemperatureDelta = 8;
+
+    /// One sample of the calibration.
+    ///
+    struct Sample {
+        uint32_t referenceTime; ///< The reference time in seconds since the first sample.
+        int32_t error; ///< The error of the RTC in milliseconds, positive if the RTC is ahead.
+        int16_t temperature; ///< The temperature in quarter degrees celsius.
+    };
+
+public:
+    /// Create a new calibration.
+    ///
+    /// @param[in] rtc The RTC driver to use.
+    ///
+    explicit DS3231Calibration(DS3231 *rtc);
+
+public:
+    /// Remove all samples.
+    ///
+    void reset();
+
+    /// Add a new sample.
+    ///
+    /// The temperature is read from the chip. If it differs more than
+    /// `cMaximumTemperatureDelta` from the temperature of the first sample, the
+    /// sample is rejected. If the storage is full, the oldest sample is replaced.
+    ///
+    /// @param[in] referenceTimeMs The time of the reference in milliseconds.
+    /// @param[in] rtcTimeMs The time of the RTC at the same moment in milliseconds.
+    /// @param[out] isAccepted Set to `true` if the sample was stored, `false` if it was rejected.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status addSample(uint64_t referenceTimeMs, uint64_t rtcTimeMs, bool &isAccepted);
+
+    /// Get the number of stored samples.
+    ///
+    inline uint8_t getSampleCount() const {
+        return _count;
+    }
+
+    /// Get a stored sample.
+    ///
+    /// @param index The index of the sample, zero is the oldest sample.
+    ///
+    const Sample& getSample(uint8_t index) const;
+
+    /// Get the drift of the RTC fitted over all samples.
+    ///
+    /// @param[out] drift The drift in parts per billion, positive if the RTC runs fast.
+    /// @return `true` on success, `false` if there are not enough samples.
+    ///
+    bool getDrift(int32_t &drift) const;
+
+    /// Calculate the optimal aging offset.
+    ///
+    /// @param[out] offset The optimal aging offset for the chip.
+    /// @return `Success` or `Error` if there was a communication problem with the chip,
+    ///     or there are not enough samples.
+    ///
+    Status computeOffset(int8_t &offset);
+
+    /// Calculate and apply the optimal aging offset.
+    ///
+    /// A temperature conversion is started to apply the new offset immediately.
+    /// All samples are removed, because they were measured with the old offset.
+    ///
+    /// @return `Success` or `Error` if there was a communication problem with the chip,
+    ///     or there are not enough samples.
+    ///
+    Status apply();
+
+private:
+    DS3231 *_rtc; ///< The RTC driver.
+    Sample _samples[cSampleCount]; ///< The ring buffer with the samples.
+    uint8_t _first; ///< The index of the oldest sample.
+    uint8_t _count; ///< The number of stored samples.
+    uint64_t _firstReferenceTime; ///< The reference time of the first sample in milliseconds.
+    int64_t _firstError; ///< The error at the first sample in milliseconds.
+    int16_t _firstTemperature; ///< The temperature at the first sample in quarter degrees celsius.
+};
+
+
+}
+
@@ -0,0 +1,359 @@
+//
+// An interpolating clock based on the DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DS3231Clock.hpp"
+
+
+#include "CivilTime.hpp"
+#include "LinearFit.hpp"
+
+
+namespace lr {
+
+
+DS3231Clock::DS3231Clock(DS3231 *rtc, DS3231::TickFunction tickFunction, uint32_t ticksPerSecond)
+    : _rtc(rtc),
+    _tickFunction(tickFunction),
+    _ticksPerSecond(ticksPerSecond),
+    _syncIntervalTicks(0),
+    _isSynchronized(false),
+    _isPhaseAligned(false),
+    _edgeTick(0),
+    _edgeCount(0),
+    _processedEdgeCount(0),
+    _anchorTick(0),
+    _anchorTime(0),
+    _lastChipReadTick(0),
+    _extendedTick(0),
+    _rate(static_cast<uint64_t>(ticksPerSecond) << 16),
+    _isRateFitted(false),
+    _driftTimes(),
+    _driftTicks(),
+    _driftCount(0),
+    _driftNext(0)
+{
+    setSyncInterval(600);
+}
+
+
+void DS3231Clock::setSyncInterval(uint32_t seconds)
+{
+    const uint64_t ticks = static_cast<uint64_t>(seconds) * _ticksPerSecond;
+    const uint64_t maximumTicks = UINT32_MAX / 2;
+    _syncIntervalTicks = static_cast<uint32_t>(ticks < maximumTicks ? ticks : maximumTicks);
+}
+
+
+DS3231Clock::Status DS3231Clock::synchronize()
+{
+    uint32_t edgeTick;
+    if (takeEdge(edgeTick)) {
+        return alignToEdge(edgeTick);
+    }
+    return readChipTime();
+}
+
+
+DS3231Clock::Status DS3231Clock::readChipTime()
+{
+    uint32_t time;
+    const uint32_t tickBefore = _tickFunction();
+    const auto status = _rtc->getUnixTime(time);
+    if (hasError(status)) {
+        return status;
+    }
+    const uint32_t tickAfter = _tickFunction();
+    _lastChipReadTick = tickAfter;
+    if (_isSynchronized && _isPhaseAligned) {
+        // Keep the aligned anchor, as long as the chip confirms it.
+        uint32_t earliest;
+        uint32_t latest;
+        uint32_t microseconds;
+        splitTicks(tickBefore - _anchorTick, earliest, microseconds);
+        splitTicks(tickAfter - _anchorTick, latest, microseconds);
+        if (time >= _anchorTime + earliest && time <= _anchorTime + latest) {
+            // Move the anchor forward by whole seconds, which keeps the phase.
+            _anchorTick += static_cast<uint32_t>((static_cast<uint64_t>(earliest) * _rate) >> 16);
+            _anchorTime += earliest;
+            return Status::Success;
+        }
+        resetDrift(); // The time of the chip was changed.
+    }
+    setAnchor(tickBefore + (tickAfter - tickBefore) / 2, time, false);
+    return Status::Success;
+}
+
+
+void DS3231Clock::onSquareWaveEdge()
+{
+    _edgeTick = _tickFunction();
+    _edgeCount = _edgeCount + 1;
+}
+
+
+bool DS3231Clock::takeEdge(uint32_t &edgeTick)
+{
+    // Read the values until they are not changed by the interrupt in between.
+    uint32_t edgeCount;
+    do {
+        edgeCount = _edgeCount;
+        edgeTick = _edgeTick;
+    } while (edgeCount != _edgeCount);
+    if (edgeCount == _processedEdgeCount) {
+        return false;
+    }
+    _processedEdgeCount = edgeCount;
+    return true;
+}
+
+
+DS3231Clock::Status DS3231Clock::alignToEdge(uint32_t edgeTick)
+{
+    if (_isSynchronized) {
+        const uint32_t ticksSinceAnchor = edgeTick - _anchorTick;
+        if (static_cast<int32_t>(ticksSinceAnchor) < 0) {
+            return Status::Success; // The anchor is more recent than this edge.
+        }
+        // The edge is an exact second boundary. For an aligned anchor, the number of
+        // seconds is rounded. For an unaligned anchor, the boundary is the first one
+        // at or after the extrapolated time, because the anchor is at or after the
+        // boundary of the read second.
+        uint32_t seconds;
+        uint32_t microseconds;
+        splitTicks(ticksSinceAnchor, seconds, microseconds);
+        if (_isPhaseAligned ? microseconds >= 500000 : microseconds > 0) {
+            ++seconds;
+        }
+        setAnchor(edgeTick, _anchorTime + seconds, true);
+        return Status::Success;
+    }
+    // Read the time of the second which started with the edge.
+    uint32_t time;
+    const auto status = _rtc->getUnixTime(time);
+    if (hasError(status)) {
+        return status;
+    }
+    const uint32_t tickAfter = _tickFunction();
+    _lastChipReadTick = tickAfter;
+    if (tickAfter - edgeTick >= _ticksPerSecond) {
+        // The edge is too old, use the read time without alignment.
+        setAnchor(tickAfter, time, false);
+    } else {
+        setAnchor(edgeTick, time, true);
+    }
+    return Status::Success;
+}
+
+
+void DS3231Clock::setAnchor(uint32_t tick, uint32_t time, bool isPhaseAligned)
+{
+    _anchorTick = tick;
+    _anchorTime = time;
+    _isSynchronized = true;
+    _isPhaseAligned = isPhaseAligned;
+    if (isPhaseAligned) {
+        addDriftSample();
+    }
+}
+
+
+int64_t DS3231Clock::extendTick(uint32_t tick)
+{
+    // The difference to the last seen value is correct, as long as it is seen once per wrap around.
+    const int64_t extendedTick = _extendedTick + static_cast<int32_t>(tick - static_cast<uint32_t>(_extendedTick));
+    if (extendedTick > _extendedTick) {
+        _extendedTick = extendedTick;
+    }
+    return extendedTick;
+}
+
+
+void DS3231Clock::addDriftSample()
+{
+    const int64_t extendedTick = extendTick(_anchorTick);
+    if (_driftCount > 0) {
+        const uint8_t lastIndex = static_cast<uint8_t>((_driftNext + cDriftSampleCount - 1) % cDriftSampleCount);
+        if (static_cast<int64_t>(_anchorTime) - _driftTimes[lastIndex] < static_cast<int64_t>(cDriftSampleSpacing)) {
+            return;
+        }
+    }
+    _driftTimes[_driftNext] = _anchorTime;
+    _driftTicks[_driftNext] = extendedTick;
+    _driftNext = static_cast<uint8_t>((_driftNext + 1) % cDriftSampleCount);
+    if (_driftCount < cDriftSampleCount) {
+        ++_driftCount;
+    }
+    // The order of the pairs does not matter for the fit.
+    int64_t rate;
+    if (!LinearFit::getSlope(_driftTimes, _driftTicks, _driftCount, 0x10000, rate)) {
+        return;
+    }
+    // Ignore implausible results, which are caused by missed wrap arounds or time changes.
+    const int64_t nominalRate = static_cast<int64_t>(_ticksPerSecond) << 16;
+    const int64_t maximumDeviation = nominalRate / 100;
+    if (rate < nominalRate - maximumDeviation || rate > nominalRate + maximumDeviation) {
+        resetDrift();
+        return;
+    }
+    _rate = static_cast<uint64_t>(rate);
+    _isRateFitted = true;
+}
+
+
+void DS3231Clock::resetDrift()
+{
+    _driftCount = 0;
+    _driftNext = 0;
+    _rate = static_cast<uint64_t>(_ticksPerSecond) << 16;
+    _isRateFitted = false;
+}
+
+
+bool DS3231Clock::getTickDrift(int32_t &drift) const
+{
+    if (!_isRateFitted) {
+        return false;
+    }
+    const int64_t nominalRate = static_cast<int64_t>(_ticksPerSecond) << 16;
+    drift = static_cast<int32_t>((static_cast<int64_t>(_rate) - nominalRate) * 1000000000 / nominalRate);
+    return true;
+}
+
+
+void DS3231Clock::splitTicks(uint32_t ticks, uint32_t &seconds, uint32_t &microseconds) const
+{
+    const uint64_t scaledTicks = static_cast<uint64_t>(ticks) << 16;
+    seconds = static_cast<uint32_t>(scaledTicks / _rate);
+    microseconds = static_cast<uint32_t>((scaledTicks % _rate) * 1000000u / _rate);
+}
+
+
+DS3231Clock::Status DS3231Clock::update(uint32_t &elapsedTicks)
+{
+    uint32_t edgeTick;
+    if (takeEdge(edgeTick)) {
+        const auto status = alignToEdge(edgeTick);
+        if (hasError(status)) {
+            return status;
+        }
+    }
+    uint32_t tick = _tickFunction();
+    extendTick(tick);
+    // The edges move the anchor forward, so the interval is measured from the last read.
+    // This read detects a changed time of the chip, while the edges keep arriving.
+    if (!_isSynchronized || tick - _lastChipReadTick >= _syncIntervalTicks) {
+        const auto status = _isSynchronized ? readChipTime() : synchronize();
+        if (hasError(status)) {
+            return status;
+        }
+        tick = _tickFunction();
+        extendTick(tick);
+    }
+    elapsedTicks = tick - _anchorTick;
+    return Status::Success;
+}
+
+
+DS3231Clock::Status DS3231Clock::now(uint32_t &unixTime, uint32_t &microseconds)
+{
+    uint32_t elapsedTicks;
+    const auto status = update(elapsedTicks);
+    if (hasError(status)) {
+        return status;
+    }
+    uint32_t seconds;
+    splitTicks(elapsedTicks, seconds, microseconds);
+    unixTime = _anchorTime + seconds;
+    return Status::Success;
+}
+
+
+DS3231Clock::Status DS3231Clock::now(uint64_t &unixTimeMs)
+{
+    uint32_t unixTime;
+    uint32_t microseconds;
+    const auto status = now(unixTime, microseconds);
+    if (hasError(status)) {
+        return status;
+    }
+    unixTimeMs = static_cast<uint64_t>(unixTime) * 1000u + microseconds / 1000u;
+    return Status::Success;
+}
+
+
+DS3231Clock::Status DS3231Clock::now(DateTime &dateTime)
+{
+    uint32_t unixTime;
+    uint32_t microseconds;
+    const auto status = now(unixTime, microseconds);
+    if (hasError(status)) {
+        return status;
+    }
+    dateTime = CivilTime::toDateTime(unixTime);
+    return Status::Success;
+}
+
+
+DS3231Clock::Status DS3231Clock::getTimeRecord(DS3231TimeRecordMs &record)
+{
+    uint32_t unixTime;
+    uint32_t microseconds;
+    const auto status = now(unixTime, microseconds);
+    if (hasError(status)) {
+        return status;
+    }
+    CivilTime::Fields fields;
+    CivilTime::fromUnixTime(unixTime, fields);
+    const uint16_t yearBase = _rtc->getYearBase();
+    if (fields.year < yearBase || !DS3231TimeRecordMs::fromValues(static_cast<uint16_t>(fields.year - yearBase),
+        fields.month, fields.day, fields.hour, fields.minute, fields.second,
+        static_cast<uint16_t>(microseconds / 1000u), record)) {
+        return Status::Error;
+    }
+    return Status::Success;
+}
+
+
+DS3231Clock::Status DS3231Clock::timestampBatch(const uint32_t *ticks, uint32_t count, uint64_t *unixTimeMs)
+{
+    uint32_t elapsedTicks;
+    const auto status = update(elapsedTicks);
+    if (hasError(status)) {
+        return status;
+    }
+    // The milliseconds per tick as fixed point value. Reduce the fraction bits until
+    // the factor has 32 bits, so the product with a 31 bit delta never overflows.
+    uint8_t shift = 32;
+    uint64_t factor = (static_cast<uint64_t>(1000u) << 48) / _rate;
+    while (factor > UINT32_MAX) {
+        --shift;
+        factor >>= 1;
+    }
+    const auto anchorTick = _anchorTick;
+    const auto anchorMs = static_cast<int64_t>(_anchorTime) * 1000;
+    const auto scale = static_cast<int64_t>(factor);
+    for (uint32_t i = 0; i < count; ++i) {
+        const auto delta = static_cast<int64_t>(static_cast<int32_t>(ticks[i] - anchorTick));
+        unixTimeMs[i] = static_cast<uint64_t>(anchorMs + ((delta * scale) >> shift));
+    }
+    return Status::Success;
+}
+
+
+}
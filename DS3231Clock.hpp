@@ -0,0 +1,208 @@
+#pragma once
+//
+// An interpolating clock based on the DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "DS3231.hpp"
+#include "DS3231TimeRecord.hpp"
+
+
+namespace lr {
+
+
+/// A clock which reads the RTC only once in a while.
+///
+/// The clock reads the time from the RTC once and uses a tick counter of the
+/// host to extrapolate the current time from this anchor. The time is read
+/// from the chip again after the configured synchronization interval.
+///
+/// If the INT/SQW pin of the chip is configured as 1Hz square wave, call
+/// `onSquareWaveEdge()` from the interrupt handler of the pin. The clock uses the
+/// edges to align the sub second part to the exact second boundary of the chip.
+///
+/// Every phase aligned anchor, at most one in `cDriftSampleSpacing` seconds, is
+/// stored as a pair of RTC second and tick counter. The rate of the tick counter
+/// is fitted over these pairs, which compensates the drift of the host clock
+/// against the RTC. With this correction, longer synchronization intervals keep
+/// the same accuracy. The tick function has to be called by the clock at least
+/// once per wrap around period of the counter for the drift fit to stay valid.
+///
+/// All times are handled as seconds since 1970-01-01, see `CivilTime`.
+///
+class DS3231Clock
+{
+public:
+    /// The status of function calls
+    ///
+    using Status = DS3231::Status;
+
+    /// The number of stored pairs for the drift compensation.
+    ///
+    constexpr static const uint8_t cDriftSampleCount = 16;
+
+    /// The minimum number of seconds between two stored pairs.
+    ///
+    constexpr static const uint32_t cDriftSampleSpacing = 10;
+
+public:
+    /// Create a new clock.
+    ///
+    /// @param[in] rtc The RTC driver to use.
+    /// @param[in] tickFunction The function to read the tick counter of the host.
+    /// @param[in] ticksPerSecond The frequency of the tick counter.
+    ///
+    DS3231Clock(DS3231 *rtc, DS3231::TickFunction tickFunction, uint32_t ticksPerSecond = 1000000);
+
+public:
+    /// Set the synchronization interval.
+    ///
+    /// The interval is limited to half of the wrap around period of the tick counter.
+    /// For a counter with 1MHz, this is about 35 minutes.
+    ///
+    /// @param[in] seconds The interval in seconds after which the time is read from the chip again.
+    ///
+    void setSyncInterval(uint32_t seconds);
+
+    /// Read the time from the chip now.
+    ///
+    /// @return `Success` or `Error` if there was a communication problem with the chip,
+    ///     or the time of the chip is after 2106-02-07 06:28:15.
+    ///
+    Status synchronize();
+
+    /// Check if the clock was synchronized with the chip.
+    ///
+    inline bool isSynchronized() const {
+        return _isSynchronized;
+    }
+
+    /// Check if the sub second part is aligned to the second boundary of the chip.
+    ///
+    inline bool isPhaseAligned() const {
+        return _isPhaseAligned;
+    }
+
+    /// Get the fitted drift of the tick counter against the RTC.
+    ///
+    /// @param[out] drift The drift in parts per billion, positive if the tick counter runs fast.
+    /// @return `true` if the drift was fitted, `false` if there are not enough pairs.
+    ///
+    bool getTickDrift(int32_t &drift) const;
+
+    /// Notify the clock about an edge of the 1Hz square wave.
+    ///
+    /// Call this method from the interrupt handler of the INT/SQW pin, for the falling
+    /// edge which coincides with the seconds update of the chip. The method only
+    /// captures the tick counter and never accesses the bus. The edge is processed
+    /// with the next call of `now()` or `synchronize()`.
+    ///
+    void onSquareWaveEdge();
+
+    /// Get the current time.
+    ///
+    /// The time is read from the chip only if the synchronization interval elapsed
+    /// since the last read, also while square wave edges arrive.
+    /// Without square wave edges, the sub second part is relative to the moment
+    /// when the time was read from the chip.
+    ///
+    /// @param[out] unixTime The seconds since 1970-01-01.
+    /// @param[out] microseconds The sub second part in microseconds.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status now(uint32_t &unixTime, uint32_t &microseconds);
+
+    /// Get the current time in milliseconds since 1970-01-01.
+    ///
+    /// @param[out] unixTimeMs The milliseconds since 1970-01-01.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status now(uint64_t &unixTimeMs);
+
+    /// Get the current date/time.
+    ///
+    /// @param[out] dateTime The variable where the current date/time is stored.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status now(DateTime &dateTime);
+
+    /// Convert captured tick counter values into times.
+    ///
+    /// The clock is updated once, then all values are converted relative to the same
+    /// anchor with the fitted rate of the tick counter. The conversion loop uses one
+    /// multiplication and shift per value, without division or branches, so the
+    /// compiler can vectorize it. The values have to be captured within half of the
+    /// wrap around period of the counter around the anchor.
+    ///
+    /// The times are milliseconds since 1970-01-01 as 64 bit values, because 32 bit
+    /// values would overflow after 49 days.
+    ///
+    /// @param[in] ticks The captured values of the tick counter.
+    /// @param[in] count The number of values to convert.
+    /// @param[out] unixTimeMs An array for `count` times in milliseconds since 1970-01-01.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status timestampBatch(const uint32_t *ticks, uint32_t count, uint64_t *unixTimeMs);
+
+    /// Get the current time as packed record with milliseconds.
+    ///
+    /// The year offset of the record is relative to the year base of the RTC driver.
+    ///
+    /// @param[out] record The variable where the record is stored.
+    /// @return `Success` or `Error` if there was a communication problem with the chip,
+    ///     or the year is outside of the range of the record.
+    ///
+    Status getTimeRecord(DS3231TimeRecordMs &record);
+
+private:
+    Status update(uint32_t &elapsedTicks);
+    bool takeEdge(uint32_t &edgeTick);
+    Status alignToEdge(uint32_t edgeTick);
+    Status readChipTime();
+    void setAnchor(uint32_t tick, uint32_t time, bool isPhaseAligned);
+    int64_t extendTick(uint32_t tick);
+    void addDriftSample();
+    void resetDrift();
+    void splitTicks(uint32_t ticks, uint32_t &seconds, uint32_t &microseconds) const;
+
+private:
+    DS3231 *_rtc; ///< The RTC driver.
+    const DS3231::TickFunction _tickFunction; ///< The function to read the tick counter.
+    const uint32_t _ticksPerSecond; ///< The frequency of the tick counter.
+    uint32_t _syncIntervalTicks; ///< The synchronization interval in ticks.
+    bool _isSynchronized; ///< If the anchor is valid.
+    bool _isPhaseAligned; ///< If the anchor is placed at a second boundary.
+    volatile uint32_t _edgeTick; ///< The tick counter at the last square wave edge.
+    volatile uint32_t _edgeCount; ///< The number of square wave edges.
+    uint32_t _processedEdgeCount; ///< The number of processed square wave edges.
+    uint32_t _anchorTick; ///< The tick counter at the anchor.
+    uint32_t _anchorTime; ///< The time at the anchor in seconds since 1970-01-01.
+    uint32_t _lastChipReadTick; ///< The tick counter after the last read of the time from the chip.
+    int64_t _extendedTick; ///< The last seen tick counter, extended to 64 bit.
+    uint64_t _rate; ///< The fitted ticks per RTC second, as 48.16 bit fixed point value.
+    bool _isRateFitted; ///< If the rate was fitted from the stored pairs.
+    int64_t _driftTimes[cDriftSampleCount]; ///< The RTC seconds of the stored pairs.
+    int64_t _driftTicks[cDriftSampleCount]; ///< The extended tick counter of the stored pairs.
+    uint8_t _driftCount; ///< The number of stored pairs.
+    uint8_t _driftNext; ///< The index for the next pair.
+};
+
+
+}
+
@@ -0,0 +1,177 @@
+#pragma once
+//
+// Register codec for the DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "CivilTime.hpp"
+#include "DS3231Bcd.hpp"
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// Conversions between the date/time registers of the chip and calendar values.
+///
+/// These functions are shared by `DS3231` and `DS3231T`. They work on the seven
+/// raw bytes of the registers `Seconds` to `Year`, in register order. With a
+/// year base known at compile time, all century calculations are folded.
+///
+namespace DS3231Codec {
+
+
+/// The number of date/time registers.
+///
+constexpr const uint8_t cDateTimeSize = 7;
+
+/// The masks for the values in the date/time registers.
+///
+constexpr const uint8_t cSecondsMask = 0x7f;
+constexpr const uint8_t cMinutesMask = 0x7f;
+constexpr const uint8_t cHoursMask = 0x3f;
+constexpr const uint8_t cDayOfWeekMask = 0x07;
+constexpr const uint8_t cDayMask = 0x3f;
+constexpr const uint8_t cMonthMask = 0x1f;
+
+/// The century bit in the month register.
+///
+constexpr const uint8_t cCenturyBit = 0x80;
+
+
+/// Get the year offset from the year base, 0-199.
+///
+/// @param data The date/time registers.
+///
+constexpr inline uint16_t decodeYearOffset(const uint8_t *data)
+{
+    return static_cast<uint16_t>(((data[5] & cCenturyBit) != 0 ? 100 : 0) + DS3231Bcd::convertBcdToBin(data[6]));
+}
+
+
+/// Decode the date/time registers into calendar values.
+///
+/// @param data The date/time registers.
+/// @param yearBase The year base of the RTC.
+/// @param fields The calendar values.
+///
+constexpr inline void decodeFields(const uint8_t *data, uint16_t yearBase, CivilTime::Fields &fields)
+{
+    fields.year = static_cast<uint16_t>(yearBase + decodeYearOffset(data));
+    fields.month = DS3231Bcd::convertBcdToBin(data[5] & cMonthMask);
+    fields.day = DS3231Bcd::convertBcdToBin(data[4] & cDayMask);
+    fields.hour = DS3231Bcd::convertBcdToBin(data[2] & cHoursMask);
+    fields.minute = DS3231Bcd::convertBcdToBin(data[1] & cMinutesMask);
+    fields.second = DS3231Bcd::convertBcdToBin(data[0] & cSecondsMask);
+    fields.dayOfWeek = static_cast<uint8_t>(data[3] & cDayOfWeekMask);
+}
+
+
+/// Encode calendar values into the date/time registers.
+///
+/// @param fields The calendar values.
+/// @param yearBase The year base of the RTC.
+/// @param data The date/time registers.
+/// @return `true` on success, `false` if the year is outside of the range of the RTC.
+///
+constexpr inline bool encodeFields(const CivilTime::Fields &fields, uint16_t yearBase, uint8_t *data)
+{
+    if (fields.year < yearBase || fields.year >= (yearBase + 200)) {
+        return false;
+    }
+    data[0] = DS3231Bcd::convertBinToBcd(fields.second);
+    data[1] = DS3231Bcd::convertBinToBcd(fields.minute);
+    data[2] = DS3231Bcd::convertBinToBcd(fields.hour);
+    data[3] = fields.dayOfWeek;
+    data[4] = DS3231Bcd::convertBinToBcd(fields.day);
+    data[5] = static_cast<uint8_t>(DS3231Bcd::convertBinToBcd(fields.month) |
+        (fields.year >= (yearBase + 100) ? cCenturyBit : 0));
+    data[6] = DS3231Bcd::convertBinToBcd(static_cast<uint8_t>(fields.year % 100));
+    return true;
+}
+
+
+/// Decode the date/time registers into a date/time.
+///
+inline DateTime decodeDateTime(const uint8_t *data, uint16_t yearBase)
+{
+    CivilTime::Fields fields{};
+    decodeFields(data, yearBase, fields);
+    return DateTime::fromUncheckedValues(fields.year, fields.month, fields.day,
+        fields.hour, fields.minute, fields.second, fields.dayOfWeek);
+}
+
+
+/// Encode a date/time into the date/time registers.
+///
+/// @return `true` on success, `false` if the year is outside of the range of the RTC.
+///
+inline bool encodeDateTime(const DateTime &dateTime, uint16_t yearBase, uint8_t *data)
+{
+    const CivilTime::Fields fields{dateTime.getYear(),
+        static_cast<uint8_t>(dateTime.getMonth()), static_cast<uint8_t>(dateTime.getDay()),
+        static_cast<uint8_t>(dateTime.getHour()), static_cast<uint8_t>(dateTime.getMinute()),
+        static_cast<uint8_t>(dateTime.getSecond()), static_cast<uint8_t>(dateTime.getDayOfWeek())};
+    return encodeFields(fields, yearBase, data);
+}
+
+
+/// Decode the date/time registers into seconds since 1970-01-01.
+///
+/// @param data The date/time registers.
+/// @param yearBase The year base of the RTC.
+/// @param unixTime The variable where the seconds are stored.
+/// @return `true` on success, `false` if the time is before 1970-01-01 or after 2106-02-07 06:28:15.
+///
+constexpr inline bool decodeUnixTime(const uint8_t *data, uint16_t yearBase, uint32_t &unixTime)
+{
+    CivilTime::Fields fields{};
+    decodeFields(data, yearBase, fields);
+    return CivilTime::toUnixTime(fields.year, fields.month, fields.day, fields.hour, fields.minute, fields.second,
+        unixTime);
+}
+
+
+/// Encode seconds since 1970-01-01 into the date/time registers.
+///
+/// @return `true` on success, `false` if the year is outside of the range of the RTC.
+///
+inline bool encodeUnixTime(uint32_t unixTime, uint16_t yearBase, uint8_t *data)
+{
+    CivilTime::Fields fields;
+    CivilTime::fromUnixTime(unixTime, fields);
+    return encodeFields(fields, yearBase, data);
+}
+
+
+/// Decode the temperature registers into quarter degrees celsius.
+///
+/// @param data The registers `TemperatureHigh` and `TemperatureLow`.
+///
+constexpr inline int16_t decodeTemperatureFixed(const uint8_t *data)
+{
+    // The registers contain a 10 bit two's complement value.
+    return static_cast<int16_t>(static_cast<int16_t>(static_cast<int8_t>(data[0])) * 4 + (data[1] >> 6));
+}
+
+
+}
+}
+
@@ -0,0 +1,134 @@
+#pragma once
+//
+// A tick source driven by the 32kHz output of the DS3231
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "DS3231.hpp"
+
+
+namespace lr {
+
+
+/// A 32 bit tick source from a 16 bit hardware timer counting the 32kHz output.
+///
+/// Connect the 32K pin of the chip to the external clock input of a timer, and
+/// enable the output with `DS3231::set32kHzOutput()`. The timer counts at the
+/// temperature compensated frequency of the chip. This class extends the 16 bit
+/// counter with an overflow count, and provides `getTicks()` as tick function
+/// for `DS3231Clock`:
+///
+/// ```
+/// uint16_t readTimer() { return TC3->COUNT16.COUNT.reg; }
+/// bool isOverflowPending() { return TC3->COUNT16.INTFLAG.bit.OVF != 0; }
+/// using PulseCounter = DS3231PulseCounter<&readTimer, &isOverflowPending>;
+/// void TC3_Handler() { /* clear flag */ PulseCounter::onOverflow(); }
+/// DS3231Clock clock(&rtc, &PulseCounter::getTicks, PulseCounter::cTicksPerSecond);
+/// ```
+///
+/// Values latched by the input capture unit of the same timer are converted
+/// with `extendCapture()`, and can be passed to `DS3231Clock::timestampBatch()`.
+///
+/// The counter state is static, so there is one state per timer function.
+///
+/// @tparam tReadCounter The function which reads the 16 bit hardware counter.
+/// @tparam tIsOverflowPending The function which reads the overflow flag of the timer,
+///     which is set until the overflow interrupt cleared it. Without this function,
+///     `getTicks()` must not be called while the overflow interrupt is blocked.
+///
+template<uint16_t (*tReadCounter)(), bool (*tIsOverflowPending)() = nullptr>
+class DS3231PulseCounter
+{
+public:
+    /// The frequency of the tick counter.
+    ///
+    constexpr static const uint32_t cTicksPerSecond = DS3231::c32kHzFrequency;
+
+public:
+    /// Count an overflow of the hardware counter.
+    ///
+    /// Call this method from the overflow interrupt of the timer.
+    ///
+    static void onOverflow() {
+        _overflowCount = static_cast<uint16_t>(_overflowCount + 1);
+    }
+
+    /// Get the extended counter value.
+    ///
+    /// If the counter wrapped around, but the overflow interrupt did not run yet,
+    /// the overflow is detected with `tIsOverflowPending`. Without this function,
+    /// this method has to be called from a context which can be interrupted by
+    /// the overflow interrupt, otherwise a pending overflow is missed.
+    ///
+    /// @return The 32 bit tick counter, which wraps around after 36 hours.
+    ///
+    static uint32_t getTicks() {
+        uint16_t high;
+        uint16_t low;
+        bool isOverflowPending;
+        do {
+            high = _overflowCount;
+            low = tReadCounter();
+            isOverflowPending = isOverflowPendingAfterRead();
+        } while (high != _overflowCount); // An overflow was counted meanwhile.
+        // A pending flag with a small value means the counter wrapped before the read.
+        // With a large value, the counter wrapped after the read.
+        if (isOverflowPending && low < 0x8000u) {
+            high = static_cast<uint16_t>(high + 1);
+        }
+        return (static_cast<uint32_t>(high) << 16) | low;
+    }
+
+    /// Extend a value of the input capture unit to the 32 bit tick counter.
+    ///
+    /// The value must have been captured less than one counter period ago,
+    /// which is two seconds at 32kHz.
+    ///
+    /// @param[in] captured The captured 16 bit counter value.
+    /// @return The 32 bit tick counter at the moment of the capture.
+    ///
+    static uint32_t extendCapture(uint16_t captured) {
+        const uint32_t ticks = getTicks();
+        uint32_t result = (ticks & 0xffff0000u) | captured;
+        if (captured > static_cast<uint16_t>(ticks)) {
+            result -= 0x10000u; // The value was captured before the last overflow.
+        }
+        return result;
+    }
+
+private:
+    static bool isOverflowPendingAfterRead() {
+        constexpr bool hasOverflowFlag = (tIsOverflowPending != nullptr);
+        if (hasOverflowFlag) {
+            return tIsOverflowPending();
+        }
+        return false;
+    }
+
+private:
+    static volatile uint16_t _overflowCount; ///< The number of counter overflows.
+};
+
+
+template<uint16_t (*tReadCounter)(), bool (*tIsOverflowPending)()>
+volatile uint16_t DS3231PulseCounter<tReadCounter, tIsOverflowPending>::_overflowCount = 0;
+
+
+}
+
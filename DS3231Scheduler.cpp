@@ -0,0 +1,231 @@
+//
+// Software alarm scheduler for the DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DS3231Scheduler.hpp"
+
+
+#include "CivilTime.hpp"
+
+
+namespace lr {
+
+
+DS3231Scheduler::DS3231Scheduler(DS3231 *rtc, Entry *storage, uint8_t capacity)
+    : _rtc(rtc), _entries(storage), _capacity(capacity), _count(0), _isAlarmDisabled(false)
+{
+}
+
+
+DS3231Scheduler::Status DS3231Scheduler::scheduleAt(uint32_t unixTime, Handler handler, uint32_t interval)
+{
+    if (_count >= _capacity || handler == nullptr) {
+        return Status::Error;
+    }
+    push(Entry{unixTime, interval, handler});
+    if (_entries[0].deadline == unixTime && _entries[0].handler == handler) {
+        return rearm(); // The new timer is the nearest one.
+    }
+    return Status::Success;
+}
+
+
+DS3231Scheduler::Status DS3231Scheduler::scheduleIn(uint32_t seconds, Handler handler, uint32_t interval)
+{
+    uint32_t now;
+    const auto status = _rtc->getUnixTime(now);
+    if (hasError(status)) {
+        return status;
+    }
+    return scheduleAt(now + seconds, handler, interval);
+}
+
+
+DS3231Scheduler::Status DS3231Scheduler::cancel(Handler handler)
+{
+    const uint32_t previousDeadline = (_count > 0) ? _entries[0].deadline : 0;
+    uint8_t index = 0;
+    while (index < _count) {
+        if (_entries[index].handler == handler) {
+            removeAt(index);
+        } else {
+            ++index;
+        }
+    }
+    if (_count == 0) {
+        return disarm(); // Do not wake up for a cancelled timer.
+    }
+    if (_entries[0].deadline != previousDeadline) {
+        return rearm();
+    }
+    return Status::Success;
+}
+
+
+DS3231Scheduler::Status DS3231Scheduler::process()
+{
+    while (_count > 0) {
+        uint32_t now;
+        auto status = _rtc->getUnixTime(now);
+        if (hasError(status)) {
+            return status;
+        }
+        if (_entries[0].deadline > now) {
+            // Program the alarm and make sure the deadline did not pass meanwhile.
+            status = arm(now);
+            if (hasError(status)) {
+                return status;
+            }
+            status = _rtc->getUnixTime(now);
+            if (hasError(status)) {
+                return status;
+            }
+            if (_entries[0].deadline > now) {
+                return Status::Success;
+            }
+        }
+        // Call all due timers.
+        while (_count > 0 && _entries[0].deadline <= now) {
+            Entry entry = _entries[0];
+            removeAt(0);
+            if (entry.interval > 0) {
+                entry.deadline += entry.interval;
+                if (entry.deadline <= now) {
+                    entry.deadline = now + entry.interval; // Skip missed calls.
+                }
+                push(entry);
+            }
+            entry.handler();
+        }
+    }
+    return disarm();
+}
+
+
+bool DS3231Scheduler::getNextDeadline(uint32_t &unixTime) const
+{
+    if (_count == 0) {
+        return false;
+    }
+    unixTime = _entries[0].deadline;
+    return true;
+}
+
+
+DS3231Scheduler::Status DS3231Scheduler::arm(uint32_t now)
+{
+    // Deadlines too far ahead use an intermediate alarm, which is programmed again.
+    uint32_t delay = (_entries[0].deadline > now) ? (_entries[0].deadline - now) : 1;
+    if (delay > DS3231::cMaximumWakeDelay) {
+        delay = DS3231::cMaximumWakeDelay;
+    }
+    DS3231::AlarmMode alarmMode;
+    DS3231::selectWakeMode(delay, DS3231::Alarm::Alarm1, alarmMode);
+    const auto status = _rtc->setAlarm1(alarmMode, CivilTime::toDateTime(now + delay));
+    if (hasError(status) || !_isAlarmDisabled) {
+        return status;
+    }
+    _isAlarmDisabled = false;
+    return _rtc->setAlarmInterruptEnabled(DS3231::Alarm::Alarm1, true);
+}
+
+
+DS3231Scheduler::Status DS3231Scheduler::rearm()
+{
+    uint32_t now;
+    const auto status = _rtc->getUnixTime(now);
+    if (hasError(status)) {
+        return status;
+    }
+    return arm(now);
+}
+
+
+DS3231Scheduler::Status DS3231Scheduler::disarm()
+{
+    if (_isAlarmDisabled) {
+        return Status::Success;
+    }
+    const auto status = _rtc->setAlarmInterruptEnabled(DS3231::Alarm::Alarm1, false);
+    if (isSuccessful(status)) {
+        _isAlarmDisabled = true;
+    }
+    return status;
+}
+
+
+void DS3231Scheduler::push(const Entry &entry)
+{
+    _entries[_count] = entry;
+    ++_count;
+    siftUp(static_cast<uint8_t>(_count - 1));
+}
+
+
+void DS3231Scheduler::removeAt(uint8_t index)
+{
+    --_count;
+    if (index == _count) {
+        return;
+    }
+    _entries[index] = _entries[_count];
+    siftUp(index);
+    siftDown(index);
+}
+
+
+void DS3231Scheduler::siftUp(uint8_t index)
+{
+    while (index > 0) {
+        const uint8_t parent = static_cast<uint8_t>((index - 1) / 2);
+        if (_entries[parent].deadline <= _entries[index].deadline) {
+            return;
+        }
+        const Entry entry = _entries[parent];
+        _entries[parent] = _entries[index];
+        _entries[index] = entry;
+        index = parent;
+    }
+}
+
+
+void DS3231Scheduler::siftDown(uint8_t index)
+{
+    while (true) {
+        const uint16_t left = static_cast<uint16_t>(index * 2 + 1);
+        const uint16_t right = static_cast<uint16_t>(left + 1);
+        uint8_t smallest = index;
+        if (left < _count && _entries[left].deadline < _entries[smallest].deadline) {
+            smallest = static_cast<uint8_t>(left);
+        }
+        if (right < _count && _entries[right].deadline < _entries[smallest].deadline) {
+            smallest = static_cast<uint8_t>(right);
+        }
+        if (smallest == index) {
+            return;
+        }
+        const Entry entry = _entries[smallest];
+        _entries[smallest] = _entries[index];
+        _entries[index] = entry;
+        index = smallest;
+    }
+}
+
+
+}
+
@@ -0,0 +1,145 @@
+#pragma once
+//
+// Software alarm scheduler for the DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "DS3231.hpp"
+
+
+namespace lr {
+
+
+/// A scheduler which multiplexes many timers onto alarm 1 of the chip.
+///
+/// All timers are kept in a min-heap, ordered by their deadline. The nearest
+/// deadline is always programmed into alarm 1, so the MCU can sleep until the
+/// INT pin wakes it up. After the alarm fired, call `process()`, e.g. from the
+/// alarm 1 handler of `DS3231AlarmDispatcher`.
+///
+/// The storage for the timers is provided by the caller, the scheduler does
+/// not allocate any memory. All times are seconds since 1970-01-01.
+///
+class DS3231Scheduler
+{
+public:
+    /// The status of function calls
+    ///
+    using Status = DS3231::Status;
+
+    /// A handler which is called if a timer is due.
+    ///
+    using Handler = void(*)();
+
+    /// One scheduled timer.
+    ///
+    struct Entry {
+        uint32_t deadline; ///< The time when the timer is due.
+        uint32_t interval; ///< The interval in seconds for repeating timers, or zero.
+        Handler handler; ///< The handler to call.
+    };
+
+public:
+    /// Create a new scheduler.
+    ///
+    /// @param[in] rtc The RTC driver to use.
+    /// @param[in] storage The storage for the timers.
+    /// @param[in] capacity The number of entries in the storage.
+    ///
+    DS3231Scheduler(DS3231 *rtc, Entry *storage, uint8_t capacity);
+
+public:
+    /// Schedule a timer at a given time.
+    ///
+    /// If the new timer is the nearest one, alarm 1 is programmed immediately.
+    /// No handler is called from this method, even if the time already passed.
+    /// In this case, the alarm fires within the next second, and `process()`
+    /// calls the handler.
+    ///
+    /// @param[in] unixTime The time when the handler is called.
+    /// @param[in] handler The handler to call.
+    /// @param[in] interval The interval in seconds to repeat the timer, or zero for a single call.
+    /// @return `Success`, or `Error` if the storage is full or there was a communication problem with the chip.
+    ///
+    Status scheduleAt(uint32_t unixTime, Handler handler, uint32_t interval = 0);
+
+    /// Schedule a timer relative to the current time.
+    ///
+    /// @param[in] seconds The delay in seconds.
+    /// @param[in] handler The handler to call.
+    /// @param[in] interval The interval in seconds to repeat the timer, or zero for a single call.
+    /// @return `Success`, or `Error` if the storage is full or there was a communication problem with the chip.
+    ///
+    Status scheduleIn(uint32_t seconds, Handler handler, uint32_t interval = 0);
+
+    /// Cancel all timers with the given handler.
+    ///
+    /// If the nearest deadline changed, alarm 1 is programmed again. If no timer
+    /// is left, the interrupt of alarm 1 is disabled. No handler is called from
+    /// this method.
+    ///
+    /// @param[in] handler The handler of the timers to remove.
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status cancel(Handler handler);
+
+    /// Call the handlers of all due timers and program the next deadline.
+    ///
+    /// The alarm is programmed with the coarsest matching mode. Deadlines more
+    /// than `DS3231::cMaximumWakeDelay` ahead use an intermediate alarm, which is
+    /// detected here and programmed again. If no timer is left, the interrupt of
+    /// alarm 1 is disabled, and enabled again with the next programmed alarm.
+    ///
+    /// @return `Success` or `Error` if there was a communication problem with the chip.
+    ///
+    Status process();
+
+    /// Get the nearest deadline.
+    ///
+    /// @param[out] unixTime The nearest deadline.
+    /// @return `true` if there is a scheduled timer, `false` if the scheduler is empty.
+    ///
+    bool getNextDeadline(uint32_t &unixTime) const;
+
+    /// Get the number of scheduled timers.
+    ///
+    inline uint8_t getCount() const {
+        return _count;
+    }
+
+private:
+    Status arm(uint32_t now);
+    Status rearm();
+    Status disarm();
+    void push(const Entry &entry);
+    void removeAt(uint8_t index);
+    void siftUp(uint8_t index);
+    void siftDown(uint8_t index);
+
+private:
+    DS3231 *_rtc; ///< The RTC driver.
+    Entry *_entries; ///< The heap with the timers.
+    const uint8_t _capacity; ///< The capacity of the heap.
+    uint8_t _count; ///< The number of timers in the heap.
+    bool _isAlarmDisabled; ///< If the interrupt of alarm 1 was disabled by the scheduler.
+};
+
+
+}
+
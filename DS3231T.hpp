@@ -0,0 +1,167 @@
+#pragma once
+//
+// A compile time configured DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "DS3231.hpp"
+#include "DS3231Codec.hpp"
+
+
+namespace lr {
+
+
+/// A DS3231 driver for the date/time path, configured at compile time.
+///
+/// The year base is a template parameter, so all century calculations are
+/// folded by the compiler. The bus type is a template parameter too: any type
+/// with the `readRegisterData()` and `writeRegisterData()` methods of
+/// `WireMasterRegisterChip<DS3231::Register>` can be used. With a concrete bus
+/// type, the register transfers can be inlined.
+///
+/// Use the runtime configurable `DS3231` class for the full feature set.
+///
+/// @tparam tYearBase The year base, see `DS3231::DS3231()`.
+/// @tparam tBus The type of the bus.
+///
+template<uint16_t tYearBase = 2000, typename tBus = WireMasterRegisterChip<DS3231::Register>>
+class DS3231T
+{
+public:
+    /// The status of function calls
+    ///
+    using Status = DS3231::Status;
+
+    /// The registers of the chip.
+    ///
+    using Register = DS3231::Register;
+
+    /// The year base for the RTC.
+    ///
+    constexpr static const uint16_t cYearBase = tYearBase;
+
+public:
+    /// Initialize the driver with a bus object.
+    ///
+    /// @param[in] bus The bus to use to communicate with the chip.
+    ///
+    explicit DS3231T(const tBus &bus)
+        : _bus(bus)
+    {
+    }
+
+    /// Initialize the driver with the default bus type.
+    ///
+    /// @param[in] bus The bus to use to communicate with the chip.
+    ///
+    explicit DS3231T(WireMaster *bus)
+        : _bus(bus, DS3231::cChipAddress)
+    {
+    }
+
+public:
+    /// Get the current date/time.
+    ///
+    /// @see DS3231::getDateTime()
+    ///
+    Status getDateTime(DateTime &dateTime) {
+        uint8_t data[DS3231Codec::cDateTimeSize];
+        if (!readDateTimeRegisters(data)) {
+            return Status::Error;
+        }
+        dateTime = DS3231Codec::decodeDateTime(data, tYearBase);
+        return Status::Success;
+    }
+
+    /// Set the date/time.
+    ///
+    /// @see DS3231::setDateTime()
+    ///
+    Status setDateTime(const DateTime &dateTime) {
+        uint8_t data[DS3231Codec::cDateTimeSize];
+        if (!DS3231Codec::encodeDateTime(dateTime, tYearBase, data)) {
+            return Status::Error; // The date is outside of the valid range.
+        }
+        return writeDateTimeRegisters(data);
+    }
+
+    /// Get the current time as seconds since 1970-01-01.
+    ///
+    /// @see DS3231::getUnixTime()
+    ///
+    Status getUnixTime(uint32_t &unixTime) {
+        static_assert(tYearBase >= 1970, "The unix time functions require a year base of 1970 or later.");
+        uint8_t data[DS3231Codec::cDateTimeSize];
+        if (!readDateTimeRegisters(data)) {
+            return Status::Error;
+        }
+        if (!DS3231Codec::decodeUnixTime(data, tYearBase, unixTime)) {
+            return Status::Error;
+        }
+        return Status::Success;
+    }
+
+    /// Set the time as seconds since 1970-01-01.
+    ///
+    /// @see DS3231::setUnixTime()
+    ///
+    Status setUnixTime(uint32_t unixTime) {
+        static_assert(tYearBase >= 1970, "The unix time functions require a year base of 1970 or later.");
+        uint8_t data[DS3231Codec::cDateTimeSize];
+        if (!DS3231Codec::encodeUnixTime(unixTime, tYearBase, data)) {
+            return Status::Error; // The time is outside of the valid range.
+        }
+        return writeDateTimeRegisters(data);
+    }
+
+    /// Get the temperature in quarter degrees celsius.
+    ///
+    /// @see DS3231::getTemperatureFixed()
+    ///
+    Status getTemperatureFixed(int16_t &quarterDegrees) {
+        uint8_t data[2];
+        if (!isSuccessful(_bus.readRegisterData(Register::TemperatureHigh, data, 2))) {
+            return Status::Error;
+        }
+        quarterDegrees = DS3231Codec::decodeTemperatureFixed(data);
+        return Status::Success;
+    }
+
+    /// Directly access the bus.
+    ///
+    inline tBus& bus() {
+        return _bus;
+    }
+
+private:
+    inline bool readDateTimeRegisters(uint8_t (&data)[DS3231Codec::cDateTimeSize]) {
+        return isSuccessful(_bus.readRegisterData(Register::Seconds, data, DS3231Codec::cDateTimeSize));
+    }
+
+    inline Status writeDateTimeRegisters(const uint8_t (&data)[DS3231Codec::cDateTimeSize]) {
+        return DS3231::statusFromBus(_bus.writeRegisterData(Register::Seconds, data, DS3231Codec::cDateTimeSize));
+    }
+
+private:
+    tBus _bus; ///< The bus for the communication.
+};
+
+
+}
+
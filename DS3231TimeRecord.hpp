@@ -0,0 +1,327 @@
+#pragma once
+//
+// Packed binary time records
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "CivilTime.hpp"
+
+#include "hal-common/DateTime.hpp"
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// A date/time packed into a few bytes, for logs in flash memory.
+///
+/// The fields are stored as bit fields in big endian order, starting with the
+/// year offset from a year base, followed by the month, day, hour, minute,
+/// second and for the 6 byte record the milliseconds:
+///
+/// | Size | Year   | Month  | Day    | Hour   | Minute | Second | Millisecond | Unused |
+/// |------|--------|--------|--------|--------|--------|--------|-------------|--------|
+/// | 4    | 6 bits | 4 bits | 5 bits | 5 bits | 6 bits | 6 bits | -           | -      |
+/// | 6    | 8 bits | 4 bits | 5 bits | 5 bits | 6 bits | 6 bits | 10 bits     | 4 bits |
+///
+/// With this layout, comparing the bytes of two records gives the chronological
+/// order. So records can be sorted and searched without unpacking them. The
+/// year base is not stored, and has to be the same for all compared records.
+///
+/// The 4 byte record covers 64 years from the year base, the 6 byte record 256
+/// years. The 4 byte record therefore does not cover the full 200 year range
+/// of the chip: with the year base 2000, the last year which can be stored is
+/// 2063, and creating a record for a later time fails.
+///
+/// @tparam tSize The size of the record in bytes, `4` or `6`.
+///
+template<uint8_t tSize>
+class DS3231TimeRecordT
+{
+    static_assert(tSize == 4 || tSize == 6, "The size of a time record has to be 4 or 6 bytes.");
+
+public:
+    /// The size of the record in bytes.
+    ///
+    constexpr static const uint8_t cSize = tSize;
+
+    /// The number of bits for the year offset.
+    ///
+    constexpr static const uint8_t cYearBits = (tSize == 4 ? 6 : 8);
+
+    /// The number of bits for the milliseconds.
+    ///
+    constexpr static const uint8_t cMillisecondBits = (tSize == 4 ? 0 : 10);
+
+    /// The number of years after the year base which can be stored.
+    ///
+    constexpr static const uint16_t cYearRange = (1u << cYearBits);
+
+    /// If the record stores milliseconds.
+    ///
+    constexpr static const bool cHasMilliseconds = (cMillisecondBits > 0);
+
+public:
+    /// Create an empty record, with all bytes zero.
+    ///
+    constexpr DS3231TimeRecordT()
+        : _bytes{}
+    {
+    }
+
+public:
+    /// Create a record from the calendar values.
+    ///
+    /// @param[in] yearOffset The year, relative to the year base.
+    /// @param[in] month The month 1-12.
+    /// @param[in] day The day of the month 1-31.
+    /// @param[in] hour The hour 0-23.
+    /// @param[in] minute The minute 0-59.
+    /// @param[in] second The second 0-59.
+    /// @param[in] millisecond The millisecond 0-999, ignored for the 4 byte record.
+    /// @param[out] record The variable where the record is stored.
+    /// @return `true` on success, `false` if a value is out of range.
+    ///
+    static bool fromValues(uint16_t yearOffset, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute,
+        uint8_t second, uint16_t millisecond, DS3231TimeRecordT &record)
+    {
+        if (yearOffset >= cYearRange || month < 1 || month > 12 || day < 1 || day > 31 ||
+            hour > 23 || minute > 59 || second > 59 || millisecond > 999) {
+            return false;
+        }
+        uint64_t value = yearOffset;
+        value = (value << 4) | month;
+        value = (value << 5) | day;
+        value = (value << 5) | hour;
+        value = (value << 6) | minute;
+        value = (value << 6) | second;
+        if (cHasMilliseconds) {
+            value = (value << cMillisecondBits) | millisecond;
+        }
+        value <<= cUnusedBits;
+        for (uint8_t i = 0; i < tSize; ++i) {
+            record._bytes[i] = static_cast<uint8_t>(value >> ((tSize - 1 - i) * 8));
+        }
+        return true;
+    }
+
+    /// Create a record from a date/time.
+    ///
+    /// @param[in] dateTime The date/time to pack.
+    /// @param[in] yearBase The year base for the record.
+    /// @param[in] millisecond The millisecond 0-999, ignored for the 4 byte record.
+    /// @param[out] record The variable where the record is stored.
+    /// @return `true` on success, `false` if the year is outside of the range.
+    ///
+    static bool fromDateTime(const DateTime &dateTime, uint16_t yearBase, uint16_t millisecond,
+        DS3231TimeRecordT &record)
+    {
+        if (dateTime.getYear() < yearBase) {
+            return false;
+        }
+        return fromValues(static_cast<uint16_t>(dateTime.getYear() - yearBase),
+            static_cast<uint8_t>(dateTime.getMonth()), static_cast<uint8_t>(dateTime.getDay()),
+            static_cast<uint8_t>(dateTime.getHour()), static_cast<uint8_t>(dateTime.getMinute()),
+            static_cast<uint8_t>(dateTime.getSecond()), millisecond, record);
+    }
+
+    /// Create a record from the raw bytes.
+    ///
+    /// @param[in] data A pointer to `cSize` bytes.
+    ///
+    static DS3231TimeRecordT fromBytes(const uint8_t *data)
+    {
+        DS3231TimeRecordT record;
+        for (uint8_t i = 0; i < tSize; ++i) {
+            record._bytes[i] = data[i];
+        }
+        return record;
+    }
+
+    /// Pack an array of date/time values into a byte buffer.
+    ///
+    /// @param[in] dateTimes The date/time values to pack.
+    /// @param[in] count The number of values.
+    /// @param[in] yearBase The year base for the records.
+    /// @param[out] data A buffer for `count * cSize` bytes.
+    /// @return `true` on success, `false` if a year is outside of the range. All
+    ///     values are packed, values out of range are stored as zero bytes.
+    ///
+    static bool encode(const DateTime *dateTimes, uint32_t count, uint16_t yearBase, uint8_t *data)
+    {
+        bool success = true;
+        for (uint32_t i = 0; i < count; ++i) {
+            DS3231TimeRecordT record;
+            if (!fromDateTime(dateTimes[i], yearBase, 0, record)) {
+                success = false;
+            }
+            record.getBytes(data + i * tSize);
+        }
+        return success;
+    }
+
+    /// Unpack a byte buffer into an array of date/time values.
+    ///
+    /// @param[in] data A buffer with `count * cSize` bytes.
+    /// @param[in] count The number of records.
+    /// @param[in] yearBase The year base of the records.
+    /// @param[out] dateTimes An array for `count` date/time values.
+    ///
+    static void decode(const uint8_t *data, uint32_t count, uint16_t yearBase, DateTime *dateTimes)
+    {
+        for (uint32_t i = 0; i < count; ++i) {
+            dateTimes[i] = fromBytes(data + i * tSize).toDateTime(yearBase);
+        }
+    }
+
+public:
+    /// Copy the raw bytes of the record.
+    ///
+    /// @param[out] data A buffer for `cSize` bytes.
+    ///
+    void getBytes(uint8_t *data) const
+    {
+        for (uint8_t i = 0; i < tSize; ++i) {
+            data[i] = _bytes[i];
+        }
+    }
+
+    /// Access the raw bytes of the record.
+    ///
+    inline const uint8_t* getData() const {
+        return _bytes;
+    }
+
+    /// Get the year offset from the year base.
+    ///
+    inline uint16_t getYearOffset() const {
+        return static_cast<uint16_t>(getValue() >> (cFieldBits - cYearBits));
+    }
+
+    /// Get the month 1-12.
+    ///
+    inline uint8_t getMonth() const {
+        return getField(cFieldBits - cYearBits - 4, 4);
+    }
+
+    /// Get the day of the month 1-31.
+    ///
+    inline uint8_t getDay() const {
+        return getField(cFieldBits - cYearBits - 9, 5);
+    }
+
+    /// Get the hour 0-23.
+    ///
+    inline uint8_t getHour() const {
+        return getField(cFieldBits - cYearBits - 14, 5);
+    }
+
+    /// Get the minute 0-59.
+    ///
+    inline uint8_t getMinute() const {
+        return getField(cFieldBits - cYearBits - 20, 6);
+    }
+
+    /// Get the second 0-59.
+    ///
+    inline uint8_t getSecond() const {
+        return getField(cMillisecondBits, 6);
+    }
+
+    /// Get the millisecond 0-999, always zero for the 4 byte record.
+    ///
+    inline uint16_t getMillisecond() const {
+        return static_cast<uint16_t>(getValue() & ((1u << cMillisecondBits) - 1u));
+    }
+
+    /// Convert the record into a date/time.
+    ///
+    /// @param[in] yearBase The year base of the record.
+    /// @return The date/time, including the day of the week.
+    ///
+    DateTime toDateTime(uint16_t yearBase) const
+    {
+        const uint16_t year = static_cast<uint16_t>(yearBase + getYearOffset());
+        const uint8_t month = getMonth();
+        const uint8_t day = getDay();
+        const uint8_t dayOfWeek = CivilTime::dayOfWeekFromDays(CivilTime::daysFromCivil(year, month, day));
+        return DateTime::fromUncheckedValues(year, month, day, getHour(), getMinute(), getSecond(), dayOfWeek);
+    }
+
+public:
+    /// Compare the records in chronological order.
+    ///
+    inline int compare(const DS3231TimeRecordT &other) const {
+        for (uint8_t i = 0; i < tSize; ++i) {
+            if (_bytes[i] != other._bytes[i]) {
+                return (_bytes[i] < other._bytes[i] ? -1 : 1);
+            }
+        }
+        return 0;
+    }
+
+    inline bool operator==(const DS3231TimeRecordT &other) const { return compare(other) == 0; }
+    inline bool operator!=(const DS3231TimeRecordT &other) const { return compare(other) != 0; }
+    inline bool operator<(const DS3231TimeRecordT &other) const { return compare(other) < 0; }
+    inline bool operator<=(const DS3231TimeRecordT &other) const { return compare(other) <= 0; }
+    inline bool operator>(const DS3231TimeRecordT &other) const { return compare(other) > 0; }
+    inline bool operator>=(const DS3231TimeRecordT &other) const { return compare(other) >= 0; }
+
+private:
+    /// The number of bits used for the fields, without the unused bits.
+    ///
+    constexpr static const uint8_t cFieldBits = cYearBits + 26 + cMillisecondBits;
+
+    /// The number of unused bits at the end of the record.
+    ///
+    constexpr static const uint8_t cUnusedBits = tSize * 8 - cFieldBits;
+
+    /// Get all fields as one value, without the unused bits.
+    ///
+    inline uint64_t getValue() const {
+        uint64_t value = 0;
+        for (uint8_t i = 0; i < tSize; ++i) {
+            value = (value << 8) | _bytes[i];
+        }
+        return value >> cUnusedBits;
+    }
+
+    /// Get a field from the value.
+    ///
+    inline uint8_t getField(uint8_t shift, uint8_t bits) const {
+        return static_cast<uint8_t>((getValue() >> shift) & ((1u << bits) - 1u));
+    }
+
+private:
+    uint8_t _bytes[tSize]; ///< The packed fields in big endian order.
+};
+
+
+/// A 4 byte time record with a resolution of seconds, for 64 years after the year base.
+///
+using DS3231TimeRecord = DS3231TimeRecordT<4>;
+
+/// A 6 byte time record with a resolution of milliseconds, for 256 years after the year base.
+///
+using DS3231TimeRecordMs = DS3231TimeRecordT<6>;
+
+
+}
+
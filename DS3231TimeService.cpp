@@ -0,0 +1,87 @@
+//
+// A shared time source for interrupts and tasks
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DS3231TimeService.hpp"
+
+
+namespace lr {
+
+
+DS3231TimeService::DS3231TimeService(DS3231 *rtc)
+    : _rtc(rtc), _samples(), _sequence(0)
+{
+}
+
+
+DS3231TimeService::Status DS3231TimeService::refresh()
+{
+    const uint32_t sequence = _sequence.load(std::memory_order_relaxed) + 1;
+    // Write into the inactive buffer, no reader copies it at this point. A reader
+    // which still copies it from two samples ago has to see the last sequence,
+    // so the writes must not move before the last publish.
+    std::atomic_thread_fence(std::memory_order_release);
+    Sample &sample = _samples[sequence & 1u];
+    const auto status = _rtc->readSnapshot(sample.snapshot);
+    if (hasError(status)) {
+        return status;
+    }
+    if (!sample.snapshot.getUnixTime(sample.unixTime)) {
+        return Status::Error;
+    }
+    sample.sequence = sequence;
+    _sequence.store(sequence, std::memory_order_release);
+    return Status::Success;
+}
+
+
+bool DS3231TimeService::read(Sample &sample) const
+{
+    while (true) {
+        const uint32_t sequence = _sequence.load(std::memory_order_acquire);
+        if (sequence == 0) {
+            return false;
+        }
+        sample = _samples[sequence & 1u];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // The buffer is only overwritten after another sample was published.
+        if (_sequence.load(std::memory_order_relaxed) == sequence) {
+            return true;
+        }
+    }
+}
+
+
+bool DS3231TimeService::readUnixTime(uint32_t &unixTime) const
+{
+    while (true) {
+        const uint32_t sequence = _sequence.load(std::memory_order_acquire);
+        if (sequence == 0) {
+            return false;
+        }
+        unixTime = _samples[sequence & 1u].unixTime;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) == sequence) {
+            return true;
+        }
+    }
+}
+
+
+}
+
@@ -0,0 +1,105 @@
+#pragma once
+//
+// A shared time source for interrupts and tasks
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "DS3231.hpp"
+
+#include <atomic>
+
+
+namespace lr {
+
+
+/// A shared time source, safe to read from any interrupt or task.
+///
+/// Only one owner calls `refresh()`, which is the only place where the bus is
+/// accessed. It reads a snapshot of all registers into the inactive one of two
+/// buffers and publishes it with a sequence counter. Readers copy the active
+/// buffer and check the counter afterwards. An interrupt which preempts the
+/// owner always reads the complete previous buffer, without waiting. A reader
+/// has to retry only if a new sample was published during its copy.
+///
+/// This is a sequence lock with two buffers. The buffers are copied without
+/// atomic operations, so a reader on another core can copy a buffer while the
+/// owner overwrites it. The fences make sure the reader sees the new sequence
+/// in this case, and discards the copy. On a single core MCU, where readers
+/// are interrupts of the owner, this can not happen.
+///
+class DS3231TimeService
+{
+public:
+    /// The status of function calls
+    ///
+    using Status = DS3231::Status;
+
+    /// One published sample.
+    ///
+    struct Sample {
+        DS3231::Snapshot snapshot; ///< The snapshot of all registers.
+        uint32_t unixTime = 0; ///< The time of the snapshot in seconds since 1970-01-01.
+        uint32_t sequence = 0; ///< The sequence number, increased with each refresh.
+    };
+
+public:
+    /// Create a new time service.
+    ///
+    /// @param[in] rtc The RTC driver, which must not be used outside of this service.
+    ///
+    explicit DS3231TimeService(DS3231 *rtc);
+
+public:
+    /// Read the chip and publish a new sample.
+    ///
+    /// Call this method only from the owner task, e.g. once per second.
+    ///
+    /// @return `Success` or `Error` if there was a communication problem with the chip,
+    ///     or the time of the chip is after 2106-02-07 06:28:15. No sample is published
+    ///     in this case.
+    ///
+    Status refresh();
+
+    /// Read the last published sample.
+    ///
+    /// This method can be called from any context.
+    ///
+    /// @param[out] sample The variable where the sample is stored.
+    /// @return `true` on success, `false` if no sample was published yet.
+    ///
+    bool read(Sample &sample) const;
+
+    /// Read the time of the last published sample.
+    ///
+    /// This method can be called from any context.
+    ///
+    /// @param[out] unixTime The time in seconds since 1970-01-01.
+    /// @return `true` on success, `false` if no sample was published yet.
+    ///
+    bool readUnixTime(uint32_t &unixTime) const;
+
+private:
+    DS3231 *_rtc; ///< The RTC driver.
+    Sample _samples[2]; ///< The two buffers, the active one is selected by the sequence.
+    std::atomic<uint32_t> _sequence; ///< The sequence of the active buffer, zero if none is published.
+};
+
+
+}
+
@@ -0,0 +1,84 @@
+#pragma once
+//
+// Fixed point linear regression
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// Fixed point linear regression for small sample sets.
+///
+namespace LinearFit {
+
+
+/// Calculate the slope of the least squares line through the given points.
+///
+/// The values are centered on their mean before the sums are calculated, which
+/// keeps the intermediate values small. The products of the centered values,
+/// summed over all points, have to fit into 63 bits.
+///
+/// @param x The x values.
+/// @param y The y values.
+/// @param count The number of points.
+/// @param scale The factor for the result.
+/// @param[out] slope The slope multiplied by `scale`.
+/// @return `true` on success, `false` if there are less than two points or all x values are equal.
+///
+inline bool getSlope(const int64_t *x, const int64_t *y, uint8_t count, int64_t scale, int64_t &slope)
+{
+    if (count < 2) {
+        return false;
+    }
+    int64_t sumX = 0;
+    int64_t sumY = 0;
+    for (uint8_t i = 0; i < count; ++i) {
+        sumX += x[i];
+        sumY += y[i];
+    }
+    const int64_t meanX = sumX / count;
+    const int64_t meanY = sumY / count;
+    int64_t sumXX = 0;
+    int64_t sumXY = 0;
+    for (uint8_t i = 0; i < count; ++i) {
+        const int64_t dx = x[i] - meanX;
+        const int64_t dy = y[i] - meanY;
+        sumXX += dx * dx;
+        sumXY += dx * dy;
+    }
+    // Reduce the precision until the scaled numerator fits.
+    const int64_t limit = INT64_MAX / (scale < 0 ? -scale : scale);
+    while (sumXY > limit || sumXY < -limit) {
+        sumXY /= 2;
+        sumXX /= 2;
+    }
+    if (sumXX == 0) {
+        return false;
+    }
+    slope = sumXY * scale / sumXX;
+    return true;
+}
+
+
+}
+}
+
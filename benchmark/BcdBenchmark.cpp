@@ -0,0 +1,105 @@
+//
+// The BCD conversion benchmark for the DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "CycleCounter.hpp"
+#include "DS3231Bcd.hpp"
+
+#include <cstdio>
+
+
+using namespace lr;
+
+
+namespace {
+
+
+/// The number of conversions in one measured batch.
+///
+constexpr uint32_t cBatchSize = 1000;
+
+/// The number of measured batches, the fastest one is reported.
+///
+constexpr uint32_t cBatchCount = 1000;
+
+
+/// The number of input values, a power of two.
+///
+constexpr uint32_t cValueCount = 128;
+
+/// The sum of all conversions, so the measured calls are not removed.
+///
+volatile uint32_t gSink;
+
+
+/// The previous conversion, using a division by ten.
+///
+inline uint8_t convertBinToBcdArithmetic(uint8_t value)
+{
+    return static_cast<uint8_t>(((value / 10u) << 4) | (value % 10u));
+}
+
+
+/// Measure a conversion in counts per call.
+///
+template<typename tFunction>
+double measure(tFunction function, const volatile uint8_t *values)
+{
+    uint32_t sum = 0;
+    uint32_t fastest = UINT32_MAX;
+    for (uint32_t batch = 0; batch < cBatchCount; ++batch) {
+        const uint32_t begin = CycleCounter::read();
+        for (uint32_t i = 0; i < cBatchSize; ++i) {
+            sum += function(values[i & (cValueCount - 1)]);
+        }
+        const uint32_t duration = CycleCounter::elapsed(begin, CycleCounter::read());
+        if (duration < fastest) {
+            fastest = duration;
+        }
+    }
+    gSink = sum;
+    return static_cast<double>(fastest) / cBatchSize;
+}
+
+
+}
+
+
+int main()
+{
+    // Check the table against the arithmetic conversion first.
+    for (uint8_t value = 0; value < 100; ++value) {
+        if (DS3231Bcd::convertBinToBcd(value) != convertBinToBcdArithmetic(value) ||
+            DS3231Bcd::convertBcdToBin(convertBinToBcdArithmetic(value)) != value) {
+            std::printf("Conversion mismatch for %u\n", value);
+            return 1;
+        }
+    }
+    // The values are read through a volatile pointer, so the conversions are not folded.
+    volatile uint8_t values[cValueCount];
+    for (uint32_t i = 0; i < cValueCount; ++i) {
+        values[i] = static_cast<uint8_t>((i * 37u) % 100u);
+    }
+    CycleCounter::start();
+    std::printf("| Conversion | %s per call |\n", CycleCounter::cUnit);
+    std::printf("|---|---|\n");
+    std::printf("| `convertBinToBcd()` table | %.2f |\n", measure(DS3231Bcd::convertBinToBcd, values));
+    std::printf("| binary to BCD with division | %.2f |\n", measure(convertBinToBcdArithmetic, values));
+    return 0;
+}
+
@@ -0,0 +1,222 @@
+//
+// The bus cost benchmark for the DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DS3231.hpp"
+#include "MockDS3231.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+
+using namespace lr;
+
+
+namespace {
+
+
+/// A measured function of the driver.
+///
+struct Scenario {
+    const char *id; ///< The key of the scenario in the baseline.
+    const char *name; ///< The name of the scenario, as shown in the table.
+    void (*prepare)(DS3231 &rtc, MockDS3231 &chip); ///< Prepare the driver, not measured.
+    void (*run)(DS3231 &rtc, MockDS3231 &chip); ///< The measured calls.
+};
+
+
+/// The measured bus traffic of a scenario.
+///
+struct Result {
+    MockDS3231::Counters counters; ///< The counted transactions and bytes.
+    uint32_t time100kHz; ///< The bus time at 100kHz in microseconds.
+    uint32_t time400kHz; ///< The bus time at 400kHz in microseconds.
+};
+
+
+void prepareNothing(DS3231&, MockDS3231&)
+{
+}
+
+
+void prepareCache(DS3231 &rtc, MockDS3231&)
+{
+    rtc.setCacheEnabled(true);
+    rtc.syncCache();
+}
+
+
+void setAlarmFlags(MockDS3231 &chip)
+{
+    chip.setRegister(0x0f, static_cast<uint8_t>(chip.getRegister(0x0f) | 0x03));
+}
+
+
+const DateTime cTestTime(2019, 6, 15, 12, 30, 45);
+
+
+const DS3231::Config cTestConfig = {
+    DS3231::getPowerProfile(DS3231::PowerPreset::DeepSleepWakeOnAlarm),
+    DS3231::AlarmMode::HoursMinutesSeconds, cTestTime,
+    DS3231::AlarmMode::HoursMinutesSeconds, cTestTime};
+
+
+void prepareBegin(DS3231 &rtc, MockDS3231&)
+{
+    bool isTimeValid;
+    rtc.begin(cTestConfig, isTimeValid);
+}
+
+
+void prepareBeginWithCache(DS3231 &rtc, MockDS3231 &chip)
+{
+    rtc.setCacheEnabled(true);
+    prepareBegin(rtc, chip);
+}
+
+
+const Scenario cScenarios[] = {
+    {"getDateTime", "`getDateTime()`, `getUnixTime()`", prepareNothing, [](DS3231 &rtc, MockDS3231&) {
+        DateTime dateTime;
+        rtc.getDateTime(dateTime);
+    }},
+    {"setDateTime", "`setDateTime()`, `setUnixTime()`", prepareNothing, [](DS3231 &rtc, MockDS3231&) {
+        rtc.setDateTime(cTestTime);
+    }},
+    {"isRunning", "`isRunning()`", prepareNothing, [](DS3231 &rtc, MockDS3231&) {
+        bool isRunning;
+        rtc.isRunning(isRunning);
+    }},
+    {"isRunning.cache", "`isRunning()` with cache", prepareCache, [](DS3231 &rtc, MockDS3231&) {
+        bool isRunning;
+        rtc.isRunning(isRunning);
+    }},
+    {"getTemperature", "`getTemperature()`", prepareNothing, [](DS3231 &rtc, MockDS3231&) {
+        float temperature;
+        rtc.getTemperature(temperature);
+    }},
+    {"isAlarmSet.clear", "`isAlarm1Set()`, `isAlarm2Set()` flag clear", prepareNothing, [](DS3231 &rtc, MockDS3231&) {
+        bool isSet;
+        rtc.isAlarm1Set(isSet);
+    }},
+    {"isAlarmSet.set", "`isAlarm1Set()`, `isAlarm2Set()` flag set", prepareNothing, [](DS3231 &rtc, MockDS3231 &chip) {
+        setAlarmFlags(chip);
+        bool isSet;
+        rtc.isAlarm1Set(isSet);
+    }},
+    {"isAlarmSet.set.cache", "`isAlarm1Set()`, `isAlarm2Set()` flag set, with cache", prepareCache, [](DS3231 &rtc, MockDS3231 &chip) {
+        setAlarmFlags(chip);
+        bool isSet;
+        rtc.isAlarm1Set(isSet);
+    }},
+    {"setAlarm1", "`setAlarm1()`", prepareNothing, [](DS3231 &rtc, MockDS3231&) {
+        rtc.setAlarm1(DS3231::AlarmMode::HoursMinutesSeconds, cTestTime);
+    }},
+    {"setAlarm2", "`setAlarm2()`", prepareNothing, [](DS3231 &rtc, MockDS3231&) {
+        rtc.setAlarm2(DS3231::AlarmMode::HoursMinutesSeconds, cTestTime);
+    }},
+    {"setIntPinMode", "`setIntPinMode()`", prepareNothing, [](DS3231 &rtc, MockDS3231&) {
+        rtc.setIntPinMode(DS3231::IntPinMode::Alarm1);
+    }},
+    {"setIntPinMode.cache", "`setIntPinMode()` with cache", prepareCache, [](DS3231 &rtc, MockDS3231&) {
+        rtc.setIntPinMode(DS3231::IntPinMode::Alarm1);
+    }},
+    {"readSnapshot", "`readSnapshot()`", prepareNothing, [](DS3231 &rtc, MockDS3231&) {
+        DS3231::Snapshot snapshot;
+        rtc.readSnapshot(snapshot);
+    }},
+    {"batchCommit.cache", "`Batch::commit()` with all changes and cache", prepareCache, [](DS3231 &rtc, MockDS3231&) {
+        DS3231::Batch batch(&rtc);
+        batch.setDateTime(cTestTime);
+        batch.setAlarm1(DS3231::AlarmMode::HoursMinutesSeconds, cTestTime);
+        batch.setAlarm2(DS3231::AlarmMode::HoursMinutesSeconds, cTestTime);
+        batch.setIntPinMode(DS3231::IntPinMode::Alarm12);
+        batch.commit();
+    }},
+    {"begin.unchanged", "`begin()` with unchanged configuration", prepareBegin, [](DS3231 &rtc, MockDS3231&) {
+        bool isTimeValid;
+        rtc.begin(cTestConfig, isTimeValid);
+    }},
+    {"setAlarmIfChanged.unchanged", "`setAlarmIfChanged()` unchanged", prepareBegin, [](DS3231 &rtc, MockDS3231&) {
+        rtc.setAlarmIfChanged(DS3231::Alarm::Alarm1, DS3231::AlarmMode::HoursMinutesSeconds, cTestTime);
+    }},
+    {"setAlarmIfChanged.unchanged.cache", "`setAlarmIfChanged()` unchanged, with cache", prepareBeginWithCache,
+        [](DS3231 &rtc, MockDS3231&) {
+        rtc.setAlarmIfChanged(DS3231::Alarm::Alarm1, DS3231::AlarmMode::HoursMinutesSeconds, cTestTime);
+    }},
+};
+
+
+Result measure(const Scenario &scenario)
+{
+    MockDS3231 chip;
+    chip.setRegister(0x0f, 0x08); // A running chip, with the OSF flag cleared.
+    DS3231 rtc(&chip);
+    scenario.prepare(rtc, chip);
+    chip.resetCounters();
+    scenario.run(rtc, chip);
+    Result result;
+    result.counters = chip.getCounters();
+    result.time100kHz = chip.getBusTime(100000);
+    result.time400kHz = chip.getBusTime(400000);
+    return result;
+}
+
+
+void formatTransactions(const MockDS3231::Counters &counters, char *text, size_t size)
+{
+    if (counters.reads > 0 && counters.writes > 0) {
+        std::snprintf(text, size, "%u read%s, %u write%s",
+            counters.reads, counters.reads > 1 ? "s" : "", counters.writes, counters.writes > 1 ? "s" : "");
+    } else if (counters.reads > 0) {
+        std::snprintf(text, size, "%u read%s", counters.reads, counters.reads > 1 ? "s" : "");
+    } else if (counters.writes > 0) {
+        std::snprintf(text, size, "%u write%s", counters.writes, counters.writes > 1 ? "s" : "");
+    } else {
+        std::snprintf(text, size, "none");
+    }
+}
+
+
+}
+
+
+int main(int argc, char *argv[])
+{
+    // With `--values`, print the counters in the format of the baseline files.
+    if (argc > 1 && std::strcmp(argv[1], "--values") == 0) {
+        for (const auto &scenario : cScenarios) {
+            const auto result = measure(scenario);
+            std::printf("%s.reads\t%u\n", scenario.id, result.counters.reads);
+            std::printf("%s.writes\t%u\n", scenario.id, result.counters.writes);
+            std::printf("%s.bytes\t%u\n", scenario.id, result.counters.bytes);
+        }
+        return 0;
+    }
+    std::printf("| Function | Transactions | Bytes | 100kHz | 400kHz |\n");
+    std::printf("|---|---|---|---|---|\n");
+    for (const auto &scenario : cScenarios) {
+        const auto result = measure(scenario);
+        char transactions[32];
+        formatTransactions(result.counters, transactions, sizeof(transactions));
+        std::printf("| %s | %s | %u | %uµs | %uµs |\n", scenario.name, transactions,
+            result.counters.bytes, result.time100kHz, result.time400kHz);
+    }
+    return 0;
+}
+
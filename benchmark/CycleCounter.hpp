@@ -0,0 +1,171 @@
+#pragma once
+//
+// A cycle counter for the DS3231 benchmarks
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstdint>
+
+#if defined(__ARM_ARCH_PROFILE) && (__ARM_ARCH_PROFILE == 'M')
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+
+namespace lr {
+
+
+/// A counter to measure the duration of short code sequences.
+///
+/// On Cortex-M3 and later, the cycle counter of the DWT unit is used. Cortex-M0
+/// and M0+ cores have no DWT cycle counter, there the 24 bit SysTick timer runs
+/// at the core clock. On x86 hosts the time stamp counter is used, which counts
+/// at a constant reference rate. On all other hosts, the counter falls back to
+/// nanoseconds of the steady clock.
+///
+/// Measured sequences must be shorter than the wrap around period of the
+/// counter, which is 2^24 cycles for SysTick.
+///
+namespace CycleCounter {
+
+
+#if defined(__ARM_ARCH_PROFILE) && (__ARM_ARCH_PROFILE == 'M')
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+
+/// The unit of the counter.
+///
+constexpr const char *cUnit = "cycles";
+
+/// Start the counter.
+///
+inline void start()
+{
+    *reinterpret_cast<volatile uint32_t*>(0xE000EDFCu) |= (1u << 24); // DEMCR.TRCENA
+    *reinterpret_cast<volatile uint32_t*>(0xE0001004u) = 0; // DWT_CYCCNT
+    *reinterpret_cast<volatile uint32_t*>(0xE0001000u) |= 1u; // DWT_CTRL.CYCCNTENA
+}
+
+/// Read the counter.
+///
+inline uint32_t read()
+{
+    return *reinterpret_cast<volatile uint32_t*>(0xE0001004u);
+}
+
+/// Get the number of counts between two reads.
+///
+inline uint32_t elapsed(uint32_t begin, uint32_t end)
+{
+    return end - begin;
+}
+
+#else
+
+/// The unit of the counter.
+///
+constexpr const char *cUnit = "cycles";
+
+/// Start the counter.
+///
+inline void start()
+{
+    *reinterpret_cast<volatile uint32_t*>(0xE000E014u) = 0x00ffffffu; // SYST_RVR
+    *reinterpret_cast<volatile uint32_t*>(0xE000E018u) = 0; // SYST_CVR
+    *reinterpret_cast<volatile uint32_t*>(0xE000E010u) = 0b101; // SYST_CSR, core clock, enabled.
+}
+
+/// Read the counter.
+///
+inline uint32_t read()
+{
+    // SysTick counts down, invert it to get an increasing value.
+    return 0x00ffffffu - *reinterpret_cast<volatile uint32_t*>(0xE000E018u);
+}
+
+/// Get the number of counts between two reads.
+///
+inline uint32_t elapsed(uint32_t begin, uint32_t end)
+{
+    return (end - begin) & 0x00ffffffu;
+}
+
+#endif
+
+#elif defined(__x86_64__) || defined(__i386__)
+
+/// The unit of the counter.
+///
+constexpr const char *cUnit = "TSC ticks";
+
+/// Start the counter.
+///
+inline void start()
+{
+}
+
+/// Read the counter.
+///
+inline uint32_t read()
+{
+    return static_cast<uint32_t>(__rdtsc());
+}
+
+/// Get the number of counts between two reads.
+///
+inline uint32_t elapsed(uint32_t begin, uint32_t end)
+{
+    return end - begin;
+}
+
+#else
+
+/// The unit of the counter.
+///
+constexpr const char *cUnit = "ns";
+
+/// Start the counter.
+///
+inline void start()
+{
+}
+
+/// Read the counter.
+///
+inline uint32_t read()
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/// Get the number of counts between two reads.
+///
+inline uint32_t elapsed(uint32_t begin, uint32_t end)
+{
+    return end - begin;
+}
+
+#endif
+
+
+}
+}
+
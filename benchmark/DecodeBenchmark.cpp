@@ -0,0 +1,185 @@
+//
+// The decode benchmark for the DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "CycleCounter.hpp"
+#include "DS3231Bcd.hpp"
+#include "DS3231Codec.hpp"
+#include "DS3231TimeRecord.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+
+using namespace lr;
+
+
+namespace {
+
+
+/// The number of calls in one measured batch.
+///
+constexpr uint32_t cBatchSize = 100;
+
+/// The number of measured batches, the fastest one is reported.
+///
+constexpr uint32_t cBatchCount = 200;
+
+/// The number of input values, a power of two.
+///
+constexpr uint32_t cValueCount = 16;
+
+
+/// The register values used as input, read through a volatile index so the calls are not folded.
+///
+uint8_t gRegisters[cValueCount][DS3231Codec::cDateTimeSize];
+DateTime gDateTimes[cValueCount];
+uint32_t gUnixTimes[cValueCount];
+DS3231TimeRecord gRecords[cValueCount];
+volatile uint32_t gIndexMask = cValueCount - 1;
+volatile uint32_t gSink;
+
+
+/// A measured function.
+///
+struct Measurement {
+    const char *id; ///< The key in the baseline.
+    const char *name; ///< The name, as shown in the table.
+    uint32_t (*run)(uint32_t index); ///< One call of the measured function.
+};
+
+
+/// The reference work, a chain of dependent multiplications.
+///
+/// The baseline stores the counts of the measured functions relative to this loop,
+/// so the values do not depend on the clock frequency of the host or the counter.
+///
+const Measurement cReference = {"reference", "Reference loop", [](uint32_t index) -> uint32_t {
+    uint32_t value = index;
+    for (uint32_t i = 0; i < 8; ++i) {
+        value = value * 33u + gIndexMask;
+    }
+    return value;
+}};
+
+
+const Measurement cMeasurements[] = {
+    {"bcd.binToBcd", "`DS3231Bcd::convertBinToBcd()`", [](uint32_t index) -> uint32_t {
+        return DS3231Bcd::convertBinToBcd(static_cast<uint8_t>(index * 7u));
+    }},
+    {"bcd.bcdToBin", "`DS3231Bcd::convertBcdToBin()`", [](uint32_t index) -> uint32_t {
+        return DS3231Bcd::convertBcdToBin(gRegisters[index][0]);
+    }},
+    {"codec.decodeDateTime", "`DS3231Codec::decodeDateTime()`", [](uint32_t index) -> uint32_t {
+        return DS3231Codec::decodeDateTime(gRegisters[index], 2000).getSecond();
+    }},
+    {"codec.decodeUnixTime", "`DS3231Codec::decodeUnixTime()`", [](uint32_t index) -> uint32_t {
+        uint32_t unixTime = 0;
+        DS3231Codec::decodeUnixTime(gRegisters[index], 2000, unixTime);
+        return unixTime;
+    }},
+    {"codec.encodeDateTime", "`DS3231Codec::encodeDateTime()`", [](uint32_t index) -> uint32_t {
+        uint8_t data[DS3231Codec::cDateTimeSize];
+        if (!DS3231Codec::encodeDateTime(gDateTimes[index], 2000, data)) {
+            return 0;
+        }
+        return data[0];
+    }},
+    {"codec.encodeUnixTime", "`DS3231Codec::encodeUnixTime()`", [](uint32_t index) -> uint32_t {
+        uint8_t data[DS3231Codec::cDateTimeSize];
+        if (!DS3231Codec::encodeUnixTime(gUnixTimes[index], 2000, data)) {
+            return 0;
+        }
+        return data[0];
+    }},
+    {"record.fromDateTime", "`DS3231TimeRecord::fromDateTime()`", [](uint32_t index) -> uint32_t {
+        DS3231TimeRecord record;
+        DS3231TimeRecord::fromDateTime(gDateTimes[index], 2000, 0, record);
+        return record.getData()[3];
+    }},
+    {"record.toDateTime", "`DS3231TimeRecord::toDateTime()`", [](uint32_t index) -> uint32_t {
+        return gRecords[index].toDateTime(2000).getSecond();
+    }},
+};
+
+
+void prepareValues()
+{
+    for (uint32_t i = 0; i < cValueCount; ++i) {
+        // Spread the times over the range of the 4 byte record.
+        gUnixTimes[i] = 946684800u + i * 117000000u + i * 3677u;
+        DS3231Codec::encodeUnixTime(gUnixTimes[i], 2000, gRegisters[i]);
+        gDateTimes[i] = DS3231Codec::decodeDateTime(gRegisters[i], 2000);
+        DS3231TimeRecord::fromDateTime(gDateTimes[i], 2000, 0, gRecords[i]);
+    }
+}
+
+
+/// Measure a function, in counts per batch.
+///
+uint32_t measure(const Measurement &measurement)
+{
+    uint32_t fastest = UINT32_MAX;
+    uint32_t sum = 0;
+    for (uint32_t batch = 0; batch < cBatchCount; ++batch) {
+        const uint32_t begin = CycleCounter::read();
+        for (uint32_t i = 0; i < cBatchSize; ++i) {
+            sum += measurement.run(i & gIndexMask);
+        }
+        const uint32_t duration = CycleCounter::elapsed(begin, CycleCounter::read());
+        if (duration < fastest) {
+            fastest = duration;
+        }
+    }
+    gSink = sum;
+    return fastest;
+}
+
+
+}
+
+
+int main(int argc, char *argv[])
+{
+    // With `--values`, print the counts relative to the reference loop in per mille,
+    // in the format of the baseline files.
+    const bool isValueOutput = (argc > 1 && std::strcmp(argv[1], "--values") == 0);
+    CycleCounter::start();
+    prepareValues();
+    const uint32_t referenceCounts = measure(cReference);
+    if (referenceCounts == 0) {
+        std::printf("The counter is too coarse for the reference loop.\n");
+        return 1;
+    }
+    if (!isValueOutput) {
+        std::printf("| Function | %s per call | Relative to the reference |\n", CycleCounter::cUnit);
+        std::printf("|---|---|---|\n");
+        std::printf("| %s | %.2f | 1.00 |\n", cReference.name, static_cast<double>(referenceCounts) / cBatchSize);
+    }
+    for (const auto &measurement : cMeasurements) {
+        const uint32_t counts = measure(measurement);
+        const uint32_t relativeCounts = static_cast<uint32_t>(static_cast<uint64_t>(counts) * 1000u / referenceCounts);
+        if (isValueOutput) {
+            std::printf("%s\t%u\n", measurement.id, relativeCounts);
+        } else {
+            std::printf("| %s | %.2f | %.2f |\n", measurement.name, static_cast<double>(counts) / cBatchSize,
+                static_cast<double>(relativeCounts) / 1000.0);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+# Compare measured values with a stored baseline.
+#
+# Run with `cmake -P`, using these variables:
+#   COMMAND    A benchmark which prints `key<TAB>value` lines with `--values`.
+#   EMULATOR   Optional, runs the benchmark for a cross compiled target.
+#   SIZE_TOOL  Instead of COMMAND, a `size` tool to measure LIBRARY.
+#   LIBRARY    The static library measured with SIZE_TOOL.
+#   BASELINE   The file with the stored values, in the same format.
+#   TOLERANCE  The allowed increase in percent, zero by default.
+#   UPDATE     If `ON`, write the measured values into BASELINE instead.
+#   REPORT     If `ON`, report differences as warnings, without failing the check.
+#
+# A value above the baseline plus the tolerance fails the check. Lower values
+# are reported, so the baseline can be updated with the improvement.
+
+if(NOT DEFINED TOLERANCE)
+    set(TOLERANCE 0)
+endif()
+if(REPORT)
+    set(errorMode WARNING)
+else()
+    set(errorMode SEND_ERROR)
+endif()
+
+# Measure the values.
+set(values "")
+if(SIZE_TOOL)
+    # Berkeley format: text, data, bss, dec, hex and the object name.
+    execute_process(COMMAND ${SIZE_TOOL} -B -t ${LIBRARY}
+        OUTPUT_VARIABLE output RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${SIZE_TOOL} failed for ${LIBRARY}.")
+    endif()
+    string(REPLACE "\n" ";" lines "${output}")
+    foreach(line IN LISTS lines)
+        if(line MATCHES "^[ \t]*([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)[ \t]+[0-9]+[ \t]+[0-9a-fA-F]+[ \t]+([^ \t]+)")
+            math(EXPR flash "${CMAKE_MATCH_1} + ${CMAKE_MATCH_2}")
+            math(EXPR ram "${CMAKE_MATCH_2} + ${CMAKE_MATCH_3}")
+            set(object "${CMAKE_MATCH_4}")
+            if(object STREQUAL "(TOTALS)")
+                set(object "total")
+            endif()
+            string(APPEND values "${object}.flash\t${flash}\n${object}.ram\t${ram}\n")
+        endif()
+    endforeach()
+else()
+    execute_process(COMMAND ${EMULATOR} ${COMMAND} --values
+        OUTPUT_VARIABLE values RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${COMMAND} failed with ${result}.")
+    endif()
+endif()
+
+if(UPDATE)
+    file(WRITE ${BASELINE} "${values}")
+    message(STATUS "Updated ${BASELINE}")
+    return()
+endif()
+
+if(NOT EXISTS ${BASELINE})
+    message(FATAL_ERROR "There is no baseline ${BASELINE}.")
+endif()
+
+# Read the baseline into variables.
+file(STRINGS ${BASELINE} baselineLines)
+set(baselineKeys "")
+foreach(line IN LISTS baselineLines)
+    if(line MATCHES "^([^\t]+)\t([0-9]+)$")
+        set("baseline_${CMAKE_MATCH_1}" ${CMAKE_MATCH_2})
+        list(APPEND baselineKeys "${CMAKE_MATCH_1}")
+    endif()
+endforeach()
+
+# Compare each measured value.
+set(failures 0)
+string(REPLACE "\n" ";" lines "${values}")
+foreach(line IN LISTS lines)
+    if(NOT line MATCHES "^([^\t]+)\t([0-9]+)$")
+        continue()
+    endif()
+    set(key "${CMAKE_MATCH_1}")
+    set(value ${CMAKE_MATCH_2})
+    list(REMOVE_ITEM baselineKeys "${key}")
+    if(NOT DEFINED "baseline_${key}")
+        message(${errorMode} "${key}: ${value}, which is not in the baseline.")
+        math(EXPR failures "${failures} + 1")
+        continue()
+    endif()
+    set(expected ${baseline_${key}})
+    math(EXPR limit "${expected} + ${expected} * ${TOLERANCE} / 100")
+    if(value GREATER limit)
+        message(${errorMode} "${key}: ${value}, the baseline is ${expected}.")
+        math(EXPR failures "${failures} + 1")
+    elseif(value LESS expected)
+        message(STATUS "${key}: ${value}, improved from ${expected}.")
+    endif()
+endforeach()
+foreach(key IN LISTS baselineKeys)
+    message(${errorMode} "${key}: in the baseline, but was not measured.")
+    math(EXPR failures "${failures} + 1")
+endforeach()
+
+if(failures GREATER 0 AND REPORT)
+    message(STATUS "${failures} values do not match ${BASELINE}, reported only.")
+    return()
+elseif(failures GREATER 0)
+    message(FATAL_ERROR "${failures} values do not match ${BASELINE}.")
+endif()
+message(STATUS "All values match ${BASELINE}.")
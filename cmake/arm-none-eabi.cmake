@@ -0,0 +1,26 @@
+# Cross compile profile for Cortex-M targets with the GNU Arm Embedded Toolchain.
+#
+# cmake -S . -B build-arm -DCMAKE_TOOLCHAIN_FILE=cmake/arm-none-eabi.cmake -DHAL_DS3231_ARM_CPU=cortex-m4
+#
+# The benchmarks use semihosting for their output. To run them with `ctest`,
+# set `CMAKE_CROSSCOMPILING_EMULATOR` to a command which runs an executable on
+# the target or in an emulator. Without it, only the code size is checked.
+
+set(CMAKE_SYSTEM_NAME Generic)
+set(CMAKE_SYSTEM_PROCESSOR arm)
+
+set(HAL_DS3231_ARM_CPU "cortex-m4" CACHE STRING "The CPU for the cross compile profile.")
+
+set(CMAKE_C_COMPILER arm-none-eabi-gcc)
+set(CMAKE_CXX_COMPILER arm-none-eabi-g++)
+
+# The compiler can not link executables without a board specific setup.
+set(CMAKE_TRY_COMPILE_TARGET_TYPE STATIC_LIBRARY)
+
+set(CMAKE_C_FLAGS_INIT "-mcpu=${HAL_DS3231_ARM_CPU} -mthumb -ffunction-sections -fdata-sections")
+set(CMAKE_CXX_FLAGS_INIT "${CMAKE_C_FLAGS_INIT} -fno-exceptions -fno-rtti")
+set(CMAKE_EXE_LINKER_FLAGS_INIT "--specs=nano.specs --specs=rdimon.specs -Wl,--gc-sections")
+
+set(CMAKE_FIND_ROOT_PATH_MODE_PROGRAM NEVER)
+set(CMAKE_FIND_ROOT_PATH_MODE_LIBRARY ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_INCLUDE ONLY)
@@ -0,0 +1,105 @@
+//
+// Host stub of the hal-common date/time and string
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "hal-common/DateTime.hpp"
+#include "hal-common/String.hpp"
+
+
+namespace lr {
+
+
+namespace {
+
+int8_t calculateDayOfWeek(int16_t year, int8_t month, int8_t day)
+{
+    // Sakamoto's method, with 0 for monday.
+    static const int8_t offsets[] = {0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
+    const int y = year - (month < 3 ? 1 : 0);
+    const int sundayBased = (y + y/4 - y/100 + y/400 + offsets[month - 1] + day) % 7;
+    return static_cast<int8_t>((sundayBased + 6) % 7);
+}
+
+}
+
+
+DateTime::DateTime()
+    : DateTime(2000, 1, 1, 0, 0, 0)
+{
+}
+
+
+DateTime::DateTime(int16_t year, int8_t month, int8_t day, int8_t hour, int8_t minute, int8_t second)
+    : _year(year), _month(month), _day(day), _hour(hour), _minute(minute), _second(second),
+    _dayOfWeek(calculateDayOfWeek(year, month, day))
+{
+}
+
+
+DateTime DateTime::fromUncheckedValues(int16_t year, int8_t month, int8_t day,
+    int8_t hour, int8_t minute, int8_t second, int8_t dayOfWeek)
+{
+    DateTime result;
+    result._year = year;
+    result._month = month;
+    result._day = day;
+    result._hour = hour;
+    result._minute = minute;
+    result._second = second;
+    result._dayOfWeek = dayOfWeek;
+    return result;
+}
+
+
+bool DateTime::operator==(const DateTime &other) const
+{
+    return _year == other._year && _month == other._month && _day == other._day &&
+        _hour == other._hour && _minute == other._minute && _second == other._second;
+}
+
+
+void String::append(char c)
+{
+    _text.push_back(c);
+}
+
+
+void String::append(const char *text)
+{
+    _text.append(text);
+}
+
+
+void String::appendHex(uint8_t value)
+{
+    const char *digits = "0123456789abcdef";
+    _text.push_back(digits[value >> 4]);
+    _text.push_back(digits[value & 0x0f]);
+}
+
+
+void String::appendBin(uint8_t value)
+{
+    for (int i = 7; i >= 0; --i) {
+        _text.push_back(((value >> i) & 1) != 0 ? '1' : '0');
+    }
+}
+
+
+}
+
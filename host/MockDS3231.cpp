@@ -0,0 +1,198 @@
+//
+// A simulated DS3231 chip on a host bus
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "MockDS3231.hpp"
+
+
+namespace lr {
+
+
+namespace {
+
+// The register indexes with special write rules.
+constexpr uint8_t cControlIndex = 0x0e;
+constexpr uint8_t cStatusIndex = 0x0f;
+constexpr uint8_t cTemperatureHighIndex = 0x11;
+
+// The bits of the control and status registers.
+constexpr uint8_t cControlConv = 0x20;
+constexpr uint8_t cStatusFlags = 0x83; // OSF, A2F, A1F can only be cleared.
+constexpr uint8_t cStatusEn32kHz = 0x08;
+constexpr uint8_t cStatusBusy = 0x04;
+
+}
+
+
+MockDS3231::MockDS3231()
+    : _registers(), _pointer(0), _failureCount(0), _counters()
+{
+    reset();
+}
+
+
+void MockDS3231::reset()
+{
+    for (auto &value : _registers) {
+        value = 0;
+    }
+    // The power-on state: 2000-01-01, INTCN, RS1, RS2 set, OSF and EN32kHz set, 25°C.
+    _registers[0x03] = 0x01;
+    _registers[0x04] = 0x01;
+    _registers[0x05] = 0x01;
+    _registers[cControlIndex] = 0x1c;
+    _registers[cStatusIndex] = 0x88;
+    _registers[cTemperatureHighIndex] = 25;
+    _pointer = 0;
+}
+
+
+uint8_t MockDS3231::getRegister(uint8_t index) const
+{
+    return _registers[index % cRegisterCount];
+}
+
+
+void MockDS3231::setRegister(uint8_t index, uint8_t value)
+{
+    _registers[index % cRegisterCount] = value;
+}
+
+
+void MockDS3231::setFailureCount(uint8_t count)
+{
+    _failureCount = count;
+}
+
+
+void MockDS3231::resetCounters()
+{
+    _counters = Counters();
+}
+
+
+uint32_t MockDS3231::getBusTime(uint32_t frequency) const
+{
+    const uint64_t cycles = static_cast<uint64_t>(_counters.bytes) * 9u * 1000000u;
+    return static_cast<uint32_t>((cycles + frequency / 2) / frequency);
+}
+
+
+bool MockDS3231::startTransfer(uint8_t address, bool isRead, uint8_t byteCount)
+{
+    if (isRead) {
+        ++_counters.reads;
+    } else {
+        ++_counters.writes;
+    }
+    if (address != cChipAddress || _failureCount > 0) {
+        // The chip does not acknowledge the address.
+        if (_failureCount > 0) {
+            --_failureCount;
+        }
+        ++_counters.failures;
+        ++_counters.bytes;
+        return false;
+    }
+    _counters.bytes += byteCount;
+    return true;
+}
+
+
+void MockDS3231::writeRegister(uint8_t value)
+{
+    switch (_pointer) {
+    case cControlIndex:
+        // The conversion completes immediately, and the bit reads as zero.
+        _registers[_pointer] = static_cast<uint8_t>(value & ~cControlConv);
+        break;
+    case cStatusIndex: {
+        const uint8_t current = _registers[_pointer];
+        const uint8_t flags = static_cast<uint8_t>(current & value & cStatusFlags);
+        _registers[_pointer] = static_cast<uint8_t>(flags | (value & cStatusEn32kHz) | (current & cStatusBusy));
+        break;
+    }
+    case cTemperatureHighIndex:
+    case cTemperatureHighIndex + 1:
+        break; // Read only.
+    default:
+        _registers[_pointer] = value;
+        break;
+    }
+    _pointer = static_cast<uint8_t>((_pointer + 1) % cRegisterCount);
+}
+
+
+WireMaster::Status MockDS3231::writeBytes(uint8_t address, const uint8_t *data, uint8_t count)
+{
+    if (!startTransfer(address, false, static_cast<uint8_t>(1 + count))) {
+        return Status::Error;
+    }
+    if (count > 0) {
+        _pointer = static_cast<uint8_t>(data[0] % cRegisterCount);
+        for (uint8_t i = 1; i < count; ++i) {
+            writeRegister(data[i]);
+        }
+    }
+    return Status::Success;
+}
+
+
+WireMaster::Status MockDS3231::writeRegisterData(uint8_t address, uint8_t registerAddress, const uint8_t *data, uint8_t count)
+{
+    if (!startTransfer(address, false, static_cast<uint8_t>(2 + count))) {
+        return Status::Error;
+    }
+    _pointer = static_cast<uint8_t>(registerAddress % cRegisterCount);
+    for (uint8_t i = 0; i < count; ++i) {
+        writeRegister(data[i]);
+    }
+    return Status::Success;
+}
+
+
+WireMaster::Status MockDS3231::readBytes(uint8_t address, uint8_t *data, uint8_t count)
+{
+    if (!startTransfer(address, true, static_cast<uint8_t>(1 + count))) {
+        return Status::Error;
+    }
+    for (uint8_t i = 0; i < count; ++i) {
+        data[i] = _registers[_pointer];
+        _pointer = static_cast<uint8_t>((_pointer + 1) % cRegisterCount);
+    }
+    return Status::Success;
+}
+
+
+WireMaster::Status MockDS3231::readRegisterData(uint8_t address, uint8_t registerAddress, uint8_t *data, uint8_t count)
+{
+    // The register address is written first, then the address is sent again to read.
+    if (!startTransfer(address, true, static_cast<uint8_t>(3 + count))) {
+        return Status::Error;
+    }
+    _pointer = static_cast<uint8_t>(registerAddress % cRegisterCount);
+    for (uint8_t i = 0; i < count; ++i) {
+        data[i] = _registers[_pointer];
+        _pointer = static_cast<uint8_t>((_pointer + 1) % cRegisterCount);
+    }
+    return Status::Success;
+}
+
+
+}
+
@@ -0,0 +1,123 @@
+#pragma once
+//
+// A simulated DS3231 chip on a host bus
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "hal-common/WireMaster.hpp"
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// A bus with a simulated DS3231 chip, for host builds.
+///
+/// The simulation keeps the 19 registers of the chip, with the auto incremented
+/// register pointer and the special write rules of the control and status
+/// registers. The clock does not run by itself, use `setRegister()` to change
+/// the time. A temperature conversion completes immediately.
+///
+/// Each transfer is counted. The byte count includes the address and register
+/// bytes: a register write transmits `2 + count` bytes, a register read
+/// `3 + count` bytes. The bus time is calculated from these bytes, with 9 clock
+/// cycles per byte and without start and stop conditions.
+///
+class MockDS3231 : public WireMaster
+{
+public:
+    /// The address of the chip.
+    ///
+    constexpr static const uint8_t cChipAddress = 0x68;
+
+    /// The number of registers.
+    ///
+    constexpr static const uint8_t cRegisterCount = 0x13;
+
+    /// The counted bus traffic.
+    ///
+    struct Counters {
+        uint32_t reads = 0; ///< The number of read transactions.
+        uint32_t writes = 0; ///< The number of write transactions.
+        uint32_t bytes = 0; ///< The number of bytes on the bus.
+        uint32_t failures = 0; ///< The number of failed transactions.
+    };
+
+public:
+    /// Create a chip in the power-on reset state.
+    ///
+    MockDS3231();
+
+public:
+    /// Reset the registers to the power-on reset state.
+    ///
+    void reset();
+
+    /// Get the value of a register.
+    ///
+    uint8_t getRegister(uint8_t index) const;
+
+    /// Set the value of a register, without any write rules.
+    ///
+    void setRegister(uint8_t index, uint8_t value);
+
+    /// Let the next transfers fail.
+    ///
+    /// @param count The number of transfers to fail.
+    ///
+    void setFailureCount(uint8_t count);
+
+    /// Get the counted bus traffic.
+    ///
+    inline const Counters& getCounters() const {
+        return _counters;
+    }
+
+    /// Reset the counted bus traffic.
+    ///
+    void resetCounters();
+
+    /// Get the bus time of the counted bytes.
+    ///
+    /// @param frequency The clock frequency of the bus in Hz.
+    /// @return The rounded time in microseconds.
+    ///
+    uint32_t getBusTime(uint32_t frequency) const;
+
+public: // Implement WireMaster
+    Status writeBytes(uint8_t address, const uint8_t *data, uint8_t count) override;
+    Status writeRegisterData(uint8_t address, uint8_t registerAddress, const uint8_t *data, uint8_t count) override;
+    Status readBytes(uint8_t address, uint8_t *data, uint8_t count) override;
+    Status readRegisterData(uint8_t address, uint8_t registerAddress, uint8_t *data, uint8_t count) override;
+
+private:
+    bool startTransfer(uint8_t address, bool isRead, uint8_t byteCount);
+    void writeRegister(uint8_t value);
+
+private:
+    uint8_t _registers[cRegisterCount]; ///< The registers of the chip.
+    uint8_t _pointer; ///< The register pointer.
+    uint8_t _failureCount; ///< The number of transfers to fail.
+    Counters _counters; ///< The counted bus traffic.
+};
+
+
+}
+
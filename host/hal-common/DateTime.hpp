@@ -0,0 +1,75 @@
+#pragma once
+//
+// Host stub of the hal-common date/time
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// A date/time value.
+///
+/// This stub only provides the part of the interface used by the driver.
+/// The day of the week is `0` for monday, up to `6` for sunday.
+///
+class DateTime
+{
+public:
+    /// Create the date/time 2000-01-01 00:00:00.
+    ///
+    DateTime();
+
+    /// Create a date/time from values, the day of the week is calculated.
+    ///
+    DateTime(int16_t year, int8_t month, int8_t day, int8_t hour, int8_t minute, int8_t second);
+
+public:
+    /// Create a date/time from values, without any checks.
+    ///
+    static DateTime fromUncheckedValues(int16_t year, int8_t month, int8_t day,
+        int8_t hour, int8_t minute, int8_t second, int8_t dayOfWeek);
+
+public:
+    inline uint16_t getYear() const { return static_cast<uint16_t>(_year); }
+    inline uint8_t getMonth() const { return static_cast<uint8_t>(_month); }
+    inline uint8_t getDay() const { return static_cast<uint8_t>(_day); }
+    inline uint8_t getHour() const { return static_cast<uint8_t>(_hour); }
+    inline uint8_t getMinute() const { return static_cast<uint8_t>(_minute); }
+    inline uint8_t getSecond() const { return static_cast<uint8_t>(_second); }
+    inline uint8_t getDayOfWeek() const { return static_cast<uint8_t>(_dayOfWeek); }
+
+    bool operator==(const DateTime &other) const;
+    inline bool operator!=(const DateTime &other) const { return !(*this == other); }
+
+private:
+    int16_t _year;
+    int8_t _month;
+    int8_t _day;
+    int8_t _hour;
+    int8_t _minute;
+    int8_t _second;
+    int8_t _dayOfWeek;
+};
+
+
+}
+
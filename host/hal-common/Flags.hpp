@@ -0,0 +1,66 @@
+#pragma once
+//
+// Host stub of the hal-common flags
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstdint>
+#include <type_traits>
+
+
+namespace lr {
+
+
+/// A combination of flags from an enumeration.
+///
+template<typename tEnum>
+class Flags
+{
+public:
+    /// The type of the mask.
+    ///
+    using Mask = typename std::underlying_type<tEnum>::type;
+
+public:
+    constexpr Flags() : _mask(0) {}
+    constexpr Flags(tEnum flag) : _mask(static_cast<Mask>(flag)) {}
+    constexpr explicit Flags(Mask mask) : _mask(mask) {}
+
+public:
+    constexpr inline Mask getMask() const { return _mask; }
+    constexpr inline bool isSet(tEnum flag) const { return (_mask & static_cast<Mask>(flag)) != 0; }
+    constexpr inline Flags operator|(Flags other) const { return Flags(static_cast<Mask>(_mask | other._mask)); }
+    constexpr inline Flags operator&(Flags other) const { return Flags(static_cast<Mask>(_mask & other._mask)); }
+
+private:
+    Mask _mask; ///< The mask with the set flags.
+};
+
+
+}
+
+
+/// Declare a flags type for an enumeration.
+///
+#define LR_DECLARE_FLAGS(Enum, FlagsName) using FlagsName = ::lr::Flags<Enum>;
+
+/// Declare the operators for a flags type.
+///
+#define LR_DECLARE_OPERATORS_FOR_FLAGS(FlagsName)
+
@@ -0,0 +1,56 @@
+#pragma once
+//
+// Host stub of the hal-common status tools
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// The status of a call.
+///
+enum class CallStatus : uint8_t {
+    Success, ///< The call was successful.
+    Error ///< The call failed.
+};
+
+
+/// Check if a status is successful.
+///
+template<typename tStatus>
+constexpr inline bool isSuccessful(tStatus status)
+{
+    return status == tStatus::Success;
+}
+
+
+/// Check if a status is an error.
+///
+template<typename tStatus>
+constexpr inline bool hasError(tStatus status)
+{
+    return status != tStatus::Success;
+}
+
+
+}
+
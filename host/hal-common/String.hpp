@@ -0,0 +1,50 @@
+#pragma once
+//
+// Host stub of the hal-common string
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstdint>
+#include <string>
+
+
+namespace lr {
+
+
+/// A simple string.
+///
+/// This stub only provides the part of the interface used by the driver.
+///
+class String
+{
+public:
+    void append(char c);
+    void append(const char *text);
+    void appendHex(uint8_t value);
+    void appendBin(uint8_t value);
+    inline const char* getData() const { return _text.c_str(); }
+    inline uint32_t getLength() const { return static_cast<uint32_t>(_text.size()); }
+
+private:
+    std::string _text;
+};
+
+
+}
+
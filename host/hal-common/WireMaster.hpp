@@ -0,0 +1,79 @@
+#pragma once
+//
+// Host stub of the hal-common I2C master interface
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "StatusTools.hpp"
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// The interface of an I2C bus master.
+///
+class WireMaster
+{
+public:
+    /// The status of a bus call.
+    ///
+    using Status = CallStatus;
+
+    /// The result of a bit test.
+    ///
+    enum class BitResult : uint8_t {
+        Zero, ///< All tested bits are zero.
+        Set, ///< All tested bits are set.
+        Mixed ///< Some of the tested bits are set.
+    };
+
+    /// The operation for a bit change.
+    ///
+    enum class BitOperation : uint8_t {
+        Set, ///< Set the bits.
+        Clear, ///< Clear the bits.
+        Flip ///< Flip the bits.
+    };
+
+public:
+    virtual ~WireMaster() = default;
+
+public:
+    /// Write bytes to a chip.
+    ///
+    virtual Status writeBytes(uint8_t address, const uint8_t *data, uint8_t count) = 0;
+
+    /// Write a register address and data to a chip.
+    ///
+    virtual Status writeRegisterData(uint8_t address, uint8_t registerAddress, const uint8_t *data, uint8_t count) = 0;
+
+    /// Read bytes from a chip.
+    ///
+    virtual Status readBytes(uint8_t address, uint8_t *data, uint8_t count) = 0;
+
+    /// Write a register address to a chip and read data from it.
+    ///
+    virtual Status readRegisterData(uint8_t address, uint8_t registerAddress, uint8_t *data, uint8_t count) = 0;
+};
+
+
+}
+
@@ -0,0 +1,115 @@
+#pragma once
+//
+// Host stub of the hal-common register based chip access
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "WireMaster.hpp"
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// Access to a chip with registers on an I2C bus.
+///
+/// The bit operations are implemented as read-modify-write sequences, with
+/// one read and one write transaction.
+///
+template<typename tRegister>
+class WireMasterRegisterChip
+{
+public:
+    /// Create a new chip access.
+    ///
+    WireMasterRegisterChip(WireMaster *bus, uint8_t address)
+        : _bus(bus), _address(address)
+    {
+    }
+
+public:
+    WireMaster::Status writeRegisterData(tRegister reg, const uint8_t *data, uint8_t count) const
+    {
+        return _bus->writeRegisterData(_address, static_cast<uint8_t>(reg), data, count);
+    }
+
+    WireMaster::Status readRegisterData(tRegister reg, uint8_t *data, uint8_t count) const
+    {
+        return _bus->readRegisterData(_address, static_cast<uint8_t>(reg), data, count);
+    }
+
+    WireMaster::Status writeBits(tRegister reg, uint8_t mask, uint8_t bits) const
+    {
+        uint8_t value;
+        const auto status = readRegisterData(reg, &value, 1);
+        if (hasError(status)) {
+            return status;
+        }
+        value = static_cast<uint8_t>((value & ~mask) | (bits & mask));
+        return writeRegisterData(reg, &value, 1);
+    }
+
+    WireMaster::Status changeBits(tRegister reg, uint8_t mask, WireMaster::BitOperation operation) const
+    {
+        uint8_t value;
+        const auto status = readRegisterData(reg, &value, 1);
+        if (hasError(status)) {
+            return status;
+        }
+        switch (operation) {
+        case WireMaster::BitOperation::Set:
+            value |= mask;
+            break;
+        case WireMaster::BitOperation::Clear:
+            value = static_cast<uint8_t>(value & ~mask);
+            break;
+        default:
+            value ^= mask;
+            break;
+        }
+        return writeRegisterData(reg, &value, 1);
+    }
+
+    WireMaster::Status testBits(tRegister reg, uint8_t mask, WireMaster::BitResult &result) const
+    {
+        uint8_t value;
+        const auto status = readRegisterData(reg, &value, 1);
+        if (hasError(status)) {
+            return status;
+        }
+        value &= mask;
+        if (value == 0) {
+            result = WireMaster::BitResult::Zero;
+        } else if (value == mask) {
+            result = WireMaster::BitResult::Set;
+        } else {
+            result = WireMaster::BitResult::Mixed;
+        }
+        return status;
+    }
+
+private:
+    WireMaster *_bus; ///< The bus.
+    uint8_t _address; ///< The address of the chip.
+};
+
+
+}
+
@@ -0,0 +1,150 @@
+//
+// The tests of the DS3231AlarmDispatcher class
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DS3231AlarmDispatcher.hpp"
+#include "MockDS3231.hpp"
+#include "TestCheck.hpp"
+
+
+using namespace lr;
+
+
+namespace {
+
+
+/// The status register with EN32kHz and the alarm flags.
+///
+const uint8_t cStatusIdle = 0x08;
+const uint8_t cStatusA1F = 0x01;
+const uint8_t cStatusA2F = 0x02;
+
+
+MockDS3231 *gChip = nullptr;
+uint8_t gAlarm1Count = 0;
+uint8_t gAlarm2Count = 0;
+
+void onAlarm1()
+{
+    ++gAlarm1Count;
+}
+
+void onAlarm2()
+{
+    ++gAlarm2Count;
+}
+
+/// Alarm 2 fires while alarm 1 is handled, after the flags were read.
+///
+void onAlarm1WithAlarm2()
+{
+    ++gAlarm1Count;
+    if (gAlarm1Count == 1) {
+        gChip->setRegister(0x0f, static_cast<uint8_t>(gChip->getRegister(0x0f) | cStatusA2F));
+    }
+}
+
+
+/// A chip with a dispatcher.
+///
+struct Fixture {
+    Fixture() : chip(), rtc(&chip), dispatcher(&rtc) {
+        gChip = &chip;
+        gAlarm1Count = 0;
+        gAlarm2Count = 0;
+        chip.setRegister(0x0f, cStatusIdle);
+        dispatcher.setAlarm1Handler(&onAlarm1);
+        dispatcher.setAlarm2Handler(&onAlarm2);
+    }
+
+    MockDS3231 chip;
+    DS3231 rtc;
+    DS3231AlarmDispatcher dispatcher;
+};
+
+
+void testNoBusWithoutInterrupt()
+{
+    Fixture f;
+    f.chip.setRegister(0x0f, cStatusIdle | cStatusA1F);
+    f.chip.resetCounters();
+    LR_CHECK(f.dispatcher.process() == DS3231AlarmDispatcher::Status::Success);
+    LR_CHECK(f.chip.getCounters().reads == 0);
+    LR_CHECK(gAlarm1Count == 0);
+}
+
+
+void testDispatchBothAlarms()
+{
+    Fixture f;
+    f.chip.setRegister(0x0f, cStatusIdle | cStatusA1F | cStatusA2F);
+    f.dispatcher.onIntPinFalling();
+    LR_CHECK(f.dispatcher.isPending());
+    f.chip.resetCounters();
+    LR_CHECK(f.dispatcher.process() == DS3231AlarmDispatcher::Status::Success);
+    LR_CHECK(!f.dispatcher.isPending());
+    LR_CHECK(gAlarm1Count == 1);
+    LR_CHECK(gAlarm2Count == 1);
+    LR_CHECK(f.chip.getRegister(0x0f) == cStatusIdle);
+    // One read and one write for the flags, and one read to confirm.
+    LR_CHECK(f.chip.getCounters().reads == 2);
+    LR_CHECK(f.chip.getCounters().writes == 1);
+}
+
+
+void testAlarmDuringProcess()
+{
+    Fixture f;
+    f.dispatcher.setAlarm1Handler(&onAlarm1WithAlarm2);
+    f.chip.setRegister(0x0f, cStatusIdle | cStatusA1F);
+    f.dispatcher.onIntPinFalling();
+    LR_CHECK(f.dispatcher.process() == DS3231AlarmDispatcher::Status::Success);
+    // The INT pin stayed low, so there was no new edge, but alarm 2 is dispatched.
+    LR_CHECK(gAlarm1Count == 1);
+    LR_CHECK(gAlarm2Count == 1);
+    LR_CHECK(f.chip.getRegister(0x0f) == cStatusIdle);
+}
+
+
+void testErrorKeepsPending()
+{
+    Fixture f;
+    f.chip.setRegister(0x0f, cStatusIdle | cStatusA2F);
+    f.dispatcher.onIntPinFalling();
+    f.chip.setFailureCount(1);
+    LR_CHECK(f.dispatcher.process() == DS3231AlarmDispatcher::Status::Error);
+    LR_CHECK(f.dispatcher.isPending());
+    LR_CHECK(gAlarm2Count == 0);
+    LR_CHECK(f.dispatcher.process() == DS3231AlarmDispatcher::Status::Success);
+    LR_CHECK(!f.dispatcher.isPending());
+    LR_CHECK(gAlarm2Count == 1);
+}
+
+
+}
+
+
+int main()
+{
+    LR_RUN_TEST(testNoBusWithoutInterrupt);
+    LR_RUN_TEST(testDispatchBothAlarms);
+    LR_RUN_TEST(testAlarmDuringProcess);
+    LR_RUN_TEST(testErrorKeepsPending);
+    return TestCheck::result();
+}
+
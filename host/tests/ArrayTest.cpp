@@ -0,0 +1,201 @@
+//
+// The tests of the DS3231Array class
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DS3231Array.hpp"
+#include "MockDS3231.hpp"
+#include "TestCheck.hpp"
+
+
+using namespace lr;
+
+
+namespace {
+
+
+/// 2024-01-01 00:00:00
+///
+const uint32_t cStartTime = 1704067200;
+
+
+/// A simulated TCA9548A multiplexer, with a simulated chip on each of three channels.
+///
+class MultiplexedBus : public WireMaster
+{
+public:
+    constexpr static const uint8_t cChipCount = 3;
+
+public:
+    MultiplexedBus() : chips(), channelMask(0), switchCount(0) {
+        for (auto &chip : chips) {
+            chip.setRegister(0x0f, 0x08); // A running chip, with the OSF flag cleared.
+        }
+    }
+
+public: // Implement WireMaster
+    Status writeBytes(uint8_t address, const uint8_t *data, uint8_t count) override {
+        if (address == DS3231Array::cMultiplexerAddress) {
+            if (count != 1) {
+                return Status::Error;
+            }
+            channelMask = data[0];
+            ++switchCount;
+            return Status::Success;
+        }
+        WireMaster *chip = selectedChip();
+        return (chip != nullptr) ? chip->writeBytes(address, data, count) : Status::Error;
+    }
+    Status writeRegisterData(uint8_t address, uint8_t registerAddress, const uint8_t *data, uint8_t count) override {
+        WireMaster *chip = selectedChip();
+        return (chip != nullptr) ? chip->writeRegisterData(address, registerAddress, data, count) : Status::Error;
+    }
+    Status readBytes(uint8_t address, uint8_t *data, uint8_t count) override {
+        WireMaster *chip = selectedChip();
+        return (chip != nullptr) ? chip->readBytes(address, data, count) : Status::Error;
+    }
+    Status readRegisterData(uint8_t address, uint8_t registerAddress, uint8_t *data, uint8_t count) override {
+        WireMaster *chip = selectedChip();
+        return (chip != nullptr) ? chip->readRegisterData(address, registerAddress, data, count) : Status::Error;
+    }
+
+private:
+    WireMaster* selectedChip() {
+        for (uint8_t i = 0; i < cChipCount; ++i) {
+            if (channelMask == (1u << i)) {
+                return &chips[i];
+            }
+        }
+        return nullptr;
+    }
+
+public:
+    MockDS3231 chips[cChipCount]; ///< The chips on the channels 0-2.
+    uint8_t channelMask; ///< The control register of the multiplexer.
+    uint32_t switchCount; ///< The number of writes to the multiplexer.
+};
+
+
+/// An array with three chips.
+///
+struct Fixture {
+    Fixture() : bus(), rtc0(&bus), rtc1(&bus), rtc2(&bus), array(&bus) {
+        array.addDevice(&rtc0, 0);
+        array.addDevice(&rtc1, 1);
+        array.addDevice(&rtc2, 2);
+        setTime(0, cStartTime);
+        setTime(1, cStartTime);
+        setTime(2, cStartTime);
+        array.invalidateChannel();
+        bus.switchCount = 0;
+    }
+
+    /// Set the time of one chip.
+    ///
+    void setTime(uint8_t index, uint32_t unixTime) {
+        DS3231 *rtc;
+        array.select(index, rtc);
+        rtc->setUnixTime(unixTime);
+    }
+
+    MultiplexedBus bus;
+    DS3231 rtc0;
+    DS3231 rtc1;
+    DS3231 rtc2;
+    DS3231Array array;
+};
+
+
+void testChannelSwitches()
+{
+    Fixture f;
+    DS3231 *rtc = nullptr;
+    LR_CHECK(f.array.select(1, rtc) == DS3231Array::Status::Success);
+    LR_CHECK(rtc == &f.rtc1);
+    LR_CHECK(f.bus.channelMask == 0x02);
+    LR_CHECK(f.bus.switchCount == 1);
+    // The selected channel is not written again.
+    LR_CHECK(f.array.select(1, rtc) == DS3231Array::Status::Success);
+    LR_CHECK(f.bus.switchCount == 1);
+    // Reading all chips starts with the selected one.
+    uint32_t times[3];
+    uint8_t validMask;
+    LR_CHECK(f.array.readUnixTimes(times, validMask) == DS3231Array::Status::Success);
+    LR_CHECK(validMask == 0x07);
+    LR_CHECK(f.bus.switchCount == 3);
+    LR_CHECK(times[0] == cStartTime && times[1] == cStartTime && times[2] == cStartTime);
+    LR_CHECK(f.array.select(3, rtc) == DS3231Array::Status::Error);
+}
+
+
+void testReconciledTime()
+{
+    Fixture f;
+    f.setTime(1, cStartTime + 1);
+    f.setTime(2, cStartTime + 500);
+    uint32_t unixTime = 0;
+    uint8_t outlierMask = 0;
+    LR_CHECK(f.array.getReconciledTime(unixTime, outlierMask) == DS3231Array::Status::Success);
+    LR_CHECK(unixTime == cStartTime || unixTime == cStartTime + 1);
+    LR_CHECK(outlierMask == 0x04);
+    // Without agreement, there is no majority.
+    f.setTime(1, cStartTime + 200);
+    LR_CHECK(f.array.getReconciledTime(unixTime, outlierMask) == DS3231Array::Status::Error);
+    LR_CHECK(outlierMask == 0x06 || outlierMask == 0x05 || outlierMask == 0x03);
+}
+
+
+void testReconciledTimeWithSilentChip()
+{
+    Fixture f;
+    f.setTime(2, cStartTime + 500);
+    f.bus.chips[0].setFailureCount(100);
+    // The chips 1 and 2 answer, but do not agree.
+    uint32_t unixTime = 0;
+    uint8_t outlierMask = 0;
+    LR_CHECK(f.array.getReconciledTime(unixTime, outlierMask) == DS3231Array::Status::Error);
+    // With an agreeing pair, the silent chip is no vote against them.
+    f.bus.chips[0].setFailureCount(0);
+    f.setTime(2, cStartTime);
+    f.bus.chips[0].setFailureCount(100);
+    LR_CHECK(f.array.getReconciledTime(unixTime, outlierMask) == DS3231Array::Status::Success);
+    LR_CHECK(unixTime == cStartTime);
+    LR_CHECK(outlierMask == 0x01);
+    // A single answering chip is accepted with the default quorum, but not with a quorum of two.
+    f.bus.chips[1].setFailureCount(100);
+    LR_CHECK(f.array.getReconciledTime(unixTime, outlierMask) == DS3231Array::Status::Success);
+    LR_CHECK(outlierMask == 0x03);
+    f.array.setQuorum(2);
+    LR_CHECK(f.array.getReconciledTime(unixTime, outlierMask) == DS3231Array::Status::Error);
+    // Without any answer, the read fails.
+    f.bus.chips[2].setFailureCount(100);
+    LR_CHECK(f.array.getReconciledTime(unixTime, outlierMask) == DS3231Array::Status::Error);
+    LR_CHECK(outlierMask == 0x07);
+}
+
+
+}
+
+
+int main()
+{
+    LR_RUN_TEST(testChannelSwitches);
+    LR_RUN_TEST(testReconciledTime);
+    LR_RUN_TEST(testReconciledTimeWithSilentChip);
+    return TestCheck::result();
+}
+
@@ -0,0 +1,215 @@
+//
+// The tests of the DS3231Clock class
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DS3231Clock.hpp"
+#include "MockDS3231.hpp"
+#include "TestCheck.hpp"
+
+
+using namespace lr;
+
+
+namespace {
+
+
+/// The simulated tick counter of the host, with 1MHz.
+///
+uint32_t gTick = 0;
+
+uint32_t getTick()
+{
+    return gTick;
+}
+
+
+/// 2024-01-01 00:00:00
+///
+const uint32_t cStartTime = 1704067200;
+
+
+/// A chip and a clock, with a running time and the 1Hz edges.
+///
+struct Fixture {
+    Fixture() : chip(), rtc(&chip), clock(&rtc, &getTick, 1000000), chipTime(cStartTime) {
+        gTick = 0x10000;
+        chip.setRegister(0x0f, 0x08); // A running chip, with the OSF flag cleared.
+        rtc.setUnixTime(chipTime);
+    }
+
+    /// Advance the time of the chip and the tick counter to the next second and signal the edge.
+    ///
+    void nextSecond(uint32_t tickRate = 1000000) {
+        ++chipTime;
+        rtc.setUnixTime(chipTime);
+        gTick += tickRate;
+        clock.onSquareWaveEdge();
+    }
+
+    MockDS3231 chip;
+    DS3231 rtc;
+    DS3231Clock clock;
+    uint32_t chipTime;
+};
+
+
+void testNowWithoutEdges()
+{
+    Fixture f;
+    uint32_t unixTime;
+    uint32_t microseconds;
+    LR_CHECK(f.clock.now(unixTime, microseconds) == DS3231Clock::Status::Success);
+    LR_CHECK(f.clock.isSynchronized());
+    LR_CHECK(!f.clock.isPhaseAligned());
+    LR_CHECK(unixTime == cStartTime);
+    // Between the reads, the time is extrapolated from the tick counter.
+    f.chip.resetCounters();
+    gTick += 2500000;
+    LR_CHECK(f.clock.now(unixTime, microseconds) == DS3231Clock::Status::Success);
+    LR_CHECK(unixTime == cStartTime + 2);
+    LR_CHECK(microseconds == 500000);
+    LR_CHECK(f.chip.getCounters().reads == 0);
+}
+
+
+void testEdgeAlignment()
+{
+    Fixture f;
+    f.nextSecond();
+    gTick += 250000;
+    uint32_t unixTime;
+    uint32_t microseconds;
+    LR_CHECK(f.clock.now(unixTime, microseconds) == DS3231Clock::Status::Success);
+    LR_CHECK(f.clock.isPhaseAligned());
+    LR_CHECK(unixTime == f.chipTime);
+    LR_CHECK(microseconds == 250000);
+    // The following edges keep the alignment without bus access.
+    f.chip.resetCounters();
+    for (int i = 0; i < 5; ++i) {
+        f.nextSecond();
+        LR_CHECK(f.clock.now(unixTime, microseconds) == DS3231Clock::Status::Success);
+        LR_CHECK(unixTime == f.chipTime);
+        LR_CHECK(microseconds == 0);
+    }
+    LR_CHECK(f.chip.getCounters().reads == 0);
+}
+
+
+void testChangedChipTimeWithEdges()
+{
+    Fixture f;
+    f.clock.setSyncInterval(10);
+    f.nextSecond();
+    uint32_t unixTime;
+    uint32_t microseconds;
+    LR_CHECK(f.clock.now(unixTime, microseconds) == DS3231Clock::Status::Success);
+    LR_CHECK(f.clock.isPhaseAligned());
+    // The time of the chip is changed, while the edges keep arriving.
+    f.chipTime += 3600;
+    f.chip.resetCounters();
+    bool isChangeDetected = false;
+    for (int i = 0; i < 12; ++i) {
+        f.nextSecond();
+        LR_CHECK(f.clock.now(unixTime, microseconds) == DS3231Clock::Status::Success);
+        if (unixTime == f.chipTime) {
+            isChangeDetected = true;
+            break;
+        }
+    }
+    LR_CHECK(isChangeDetected);
+    LR_CHECK(f.chip.getCounters().reads > 0);
+    // The next edge aligns the anchor to the new time.
+    f.nextSecond();
+    LR_CHECK(f.clock.now(unixTime, microseconds) == DS3231Clock::Status::Success);
+    LR_CHECK(f.clock.isPhaseAligned());
+    LR_CHECK(unixTime == f.chipTime);
+    LR_CHECK(microseconds == 0);
+}
+
+
+void testPeriodicReadWithEdges()
+{
+    Fixture f;
+    f.clock.setSyncInterval(10);
+    f.nextSecond();
+    uint32_t unixTime;
+    uint32_t microseconds;
+    LR_CHECK(f.clock.now(unixTime, microseconds) == DS3231Clock::Status::Success);
+    // With an unchanged chip, the time is confirmed once per interval.
+    f.chip.resetCounters();
+    for (int i = 0; i < 30; ++i) {
+        f.nextSecond();
+        LR_CHECK(f.clock.now(unixTime, microseconds) == DS3231Clock::Status::Success);
+        LR_CHECK(unixTime == f.chipTime);
+    }
+    LR_CHECK(f.chip.getCounters().reads == 3);
+    LR_CHECK(f.clock.isPhaseAligned());
+}
+
+
+void testTickDrift()
+{
+    Fixture f;
+    f.nextSecond(1000100);
+    uint32_t unixTime;
+    uint32_t microseconds;
+    LR_CHECK(f.clock.now(unixTime, microseconds) == DS3231Clock::Status::Success);
+    int32_t drift;
+    LR_CHECK(!f.clock.getTickDrift(drift));
+    // A tick counter which runs fast by 100ppm.
+    for (int i = 0; i < 40; ++i) {
+        f.nextSecond(1000100);
+        LR_CHECK(f.clock.now(unixTime, microseconds) == DS3231Clock::Status::Success);
+    }
+    LR_CHECK(f.clock.getTickDrift(drift));
+    LR_CHECK(drift > 99000 && drift < 101000);
+    // The sub second part uses the fitted rate.
+    gTick += 500050;
+    LR_CHECK(f.clock.now(unixTime, microseconds) == DS3231Clock::Status::Success);
+    LR_CHECK(unixTime == f.chipTime);
+    LR_CHECK(microseconds >= 499990 && microseconds <= 500010);
+}
+
+
+void testReadError()
+{
+    Fixture f;
+    f.chip.setFailureCount(1);
+    uint32_t unixTime;
+    uint32_t microseconds;
+    LR_CHECK(f.clock.now(unixTime, microseconds) == DS3231Clock::Status::Error);
+    LR_CHECK(!f.clock.isSynchronized());
+    LR_CHECK(f.clock.now(unixTime, microseconds) == DS3231Clock::Status::Success);
+    LR_CHECK(unixTime == cStartTime);
+}
+
+
+}
+
+
+int main()
+{
+    LR_RUN_TEST(testNowWithoutEdges);
+    LR_RUN_TEST(testEdgeAlignment);
+    LR_RUN_TEST(testChangedChipTimeWithEdges);
+    LR_RUN_TEST(testPeriodicReadWithEdges);
+    LR_RUN_TEST(testTickDrift);
+    LR_RUN_TEST(testReadError);
+    return TestCheck::result();
+}
+
@@ -0,0 +1,116 @@
+//
+// The tests of the DS3231T class
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DS3231T.hpp"
+#include "MockDS3231.hpp"
+#include "TestCheck.hpp"
+
+
+using namespace lr;
+
+
+namespace {
+
+
+void testSameRegistersAsDriver()
+{
+    MockDS3231 chip;
+    chip.setRegister(0x0f, 0x08); // A running chip, with the OSF flag cleared.
+    DS3231 rtc(&chip);
+    DS3231T<2000> fixedRtc(&chip);
+    const DateTime dateTimes[] = {
+        DateTime(2000, 1, 1, 0, 0, 0),
+        DateTime(2024, 2, 29, 12, 34, 56),
+        DateTime(2099, 12, 31, 23, 59, 59),
+        DateTime(2100, 1, 1, 0, 0, 0),
+        DateTime(2199, 12, 31, 23, 59, 59),
+    };
+    for (const auto &dateTime : dateTimes) {
+        LR_CHECK(fixedRtc.setDateTime(dateTime) == DS3231::Status::Success);
+        DateTime readDateTime;
+        LR_CHECK(rtc.getDateTime(readDateTime) == DS3231::Status::Success);
+        LR_CHECK(readDateTime == dateTime);
+        LR_CHECK(fixedRtc.getDateTime(readDateTime) == DS3231::Status::Success);
+        LR_CHECK(readDateTime == dateTime);
+    }
+    // Years outside of the range are rejected, like the driver does.
+    LR_CHECK(fixedRtc.setDateTime(DateTime(1999, 12, 31, 0, 0, 0)) == DS3231::Status::Error);
+    LR_CHECK(fixedRtc.setDateTime(DateTime(2200, 1, 1, 0, 0, 0)) == DS3231::Status::Error);
+}
+
+
+void testUnixTime()
+{
+    MockDS3231 chip;
+    chip.setRegister(0x0f, 0x08);
+    DS3231 rtc(&chip);
+    DS3231T<2000> fixedRtc(&chip);
+    LR_CHECK(fixedRtc.setUnixTime(1709209696) == DS3231::Status::Success);
+    uint32_t unixTime;
+    LR_CHECK(rtc.getUnixTime(unixTime) == DS3231::Status::Success);
+    LR_CHECK(unixTime == 1709209696);
+    LR_CHECK(fixedRtc.getUnixTime(unixTime) == DS3231::Status::Success);
+    LR_CHECK(unixTime == 1709209696);
+    // The 32 bit seconds end in 2106.
+    LR_CHECK(rtc.setDateTime(DateTime(2150, 1, 1, 0, 0, 0)) == DS3231::Status::Success);
+    LR_CHECK(fixedRtc.getUnixTime(unixTime) == DS3231::Status::Error);
+}
+
+
+void testOtherYearBase()
+{
+    MockDS3231 chip;
+    chip.setRegister(0x0f, 0x08);
+    DS3231 rtc(&chip, 2100);
+    DS3231T<2100> fixedRtc(&chip);
+    static_assert(DS3231T<2100>::cYearBase == 2100, "The year base is a constant.");
+    const DateTime dateTime(2150, 6, 1, 8, 0, 0);
+    LR_CHECK(rtc.setDateTime(dateTime) == DS3231::Status::Success);
+    DateTime readDateTime;
+    LR_CHECK(fixedRtc.getDateTime(readDateTime) == DS3231::Status::Success);
+    LR_CHECK(readDateTime == dateTime);
+}
+
+
+void testTemperature()
+{
+    MockDS3231 chip;
+    DS3231 rtc(&chip);
+    DS3231T<2000> fixedRtc(&chip);
+    int16_t quarterDegrees;
+    int16_t fixedQuarterDegrees;
+    LR_CHECK(rtc.getTemperatureFixed(quarterDegrees) == DS3231::Status::Success);
+    LR_CHECK(fixedRtc.getTemperatureFixed(fixedQuarterDegrees) == DS3231::Status::Success);
+    LR_CHECK(fixedQuarterDegrees == quarterDegrees);
+    LR_CHECK(quarterDegrees == 25 * 4);
+}
+
+
+}
+
+
+int main()
+{
+    LR_RUN_TEST(testSameRegistersAsDriver);
+    LR_RUN_TEST(testUnixTime);
+    LR_RUN_TEST(testOtherYearBase);
+    LR_RUN_TEST(testTemperature);
+    return TestCheck::result();
+}
+
@@ -0,0 +1,394 @@
+//
+// The tests of the DS3231 driver
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DS3231.hpp"
+#include "MockDS3231.hpp"
+#include "TestCheck.hpp"
+
+
+using namespace lr;
+
+
+namespace {
+
+
+/// The simulated millisecond timer.
+///
+uint32_t gMilliseconds = 0;
+
+uint32_t getMilliseconds()
+{
+    return gMilliseconds;
+}
+
+
+/// A running chip, with the OSF flag cleared.
+///
+void prepareRunningChip(MockDS3231 &chip)
+{
+    chip.setRegister(0x0f, 0x08);
+}
+
+
+/// Set the time registers of the chip directly, as BCD values, for 20xx years.
+///
+void setChipTime(MockDS3231 &chip, uint8_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second)
+{
+    const auto toBcd = [](uint8_t value) { return static_cast<uint8_t>(((value / 10) << 4) | (value % 10)); };
+    chip.setRegister(0x00, toBcd(second));
+    chip.setRegister(0x01, toBcd(minute));
+    chip.setRegister(0x02, toBcd(hour));
+    chip.setRegister(0x03, 1);
+    chip.setRegister(0x04, toBcd(day));
+    chip.setRegister(0x05, toBcd(month));
+    chip.setRegister(0x06, toBcd(year));
+}
+
+
+void testDateTimeRoundTrip()
+{
+    MockDS3231 chip;
+    prepareRunningChip(chip);
+    DS3231 rtc(&chip);
+    const DateTime dateTime(2024, 2, 29, 23, 59, 58);
+    LR_CHECK(rtc.setDateTime(dateTime) == DS3231::Status::Success);
+    LR_CHECK(chip.getRegister(0x00) == 0x58);
+    LR_CHECK(chip.getRegister(0x04) == 0x29);
+    LR_CHECK(chip.getRegister(0x05) == 0x02);
+    LR_CHECK(chip.getRegister(0x06) == 0x24);
+    DateTime readDateTime;
+    LR_CHECK(rtc.getDateTime(readDateTime) == DS3231::Status::Success);
+    LR_CHECK(readDateTime == dateTime);
+    uint32_t unixTime;
+    LR_CHECK(rtc.getUnixTime(unixTime) == DS3231::Status::Success);
+    LR_CHECK(unixTime == 1709251198);
+    LR_CHECK(rtc.setUnixTime(unixTime + 2) == DS3231::Status::Success);
+    LR_CHECK(rtc.getDateTime(readDateTime) == DS3231::Status::Success);
+    LR_CHECK(readDateTime == DateTime(2024, 3, 1, 0, 0, 0));
+}
+
+
+void testUnixTimeRange()
+{
+    MockDS3231 chip;
+    prepareRunningChip(chip);
+    DS3231 rtc(&chip, 2100);
+    // The last second of the 32 bit range.
+    LR_CHECK(rtc.setDateTime(DateTime(2106, 2, 7, 6, 28, 15)) == DS3231::Status::Success);
+    uint32_t unixTime;
+    LR_CHECK(rtc.getUnixTime(unixTime) == DS3231::Status::Success);
+    LR_CHECK(unixTime == UINT32_MAX);
+    DS3231::Snapshot snapshot;
+    LR_CHECK(rtc.readSnapshot(snapshot) == DS3231::Status::Success);
+    LR_CHECK(snapshot.getUnixTime(unixTime));
+    // Later times do not wrap around.
+    LR_CHECK(rtc.setDateTime(DateTime(2106, 2, 7, 6, 28, 16)) == DS3231::Status::Success);
+    LR_CHECK(rtc.getUnixTime(unixTime) == DS3231::Status::Error);
+    LR_CHECK(rtc.setDateTime(DateTime(2150, 1, 1, 0, 0, 0)) == DS3231::Status::Success);
+    LR_CHECK(rtc.getUnixTime(unixTime) == DS3231::Status::Error);
+    LR_CHECK(rtc.readSnapshot(snapshot) == DS3231::Status::Success);
+    LR_CHECK(!snapshot.getUnixTime(unixTime));
+    // The same limit applies to incremental reads.
+    rtc.setIncrementalReadEnabled(&getMilliseconds);
+    LR_CHECK(rtc.setDateTime(DateTime(2106, 2, 7, 6, 28, 15)) == DS3231::Status::Success);
+    LR_CHECK(rtc.getUnixTime(unixTime) == DS3231::Status::Success);
+    LR_CHECK(unixTime == UINT32_MAX);
+    gMilliseconds += 1000;
+    chip.setRegister(0x00, 0x16);
+    LR_CHECK(rtc.getUnixTime(unixTime) == DS3231::Status::Error);
+}
+
+
+void testAlarmRoundTrip()
+{
+    const DS3231::AlarmMode alarm1Modes[] = {
+        DS3231::AlarmMode::OncePerSecond,
+        DS3231::AlarmMode::SecondsMatch,
+        DS3231::AlarmMode::MinutesSeconds,
+        DS3231::AlarmMode::HoursMinutesSeconds,
+        DS3231::AlarmMode::DateHoursMinutesSeconds,
+        DS3231::AlarmMode::DayHoursMinutesSeconds,
+    };
+    MockDS3231 chip;
+    prepareRunningChip(chip);
+    DS3231 rtc(&chip);
+    const DateTime dateTime(2024, 5, 17, 13, 45, 30); // A Friday.
+    for (const auto alarmMode : alarm1Modes) {
+        LR_CHECK(rtc.setAlarm1(alarmMode, dateTime) == DS3231::Status::Success);
+        DS3231::AlarmMode readMode;
+        DateTime readDateTime;
+        LR_CHECK(rtc.getAlarm1(readMode, readDateTime) == DS3231::Status::Success);
+        LR_CHECK(readMode == alarmMode);
+        if (alarmMode == DS3231::AlarmMode::HoursMinutesSeconds) {
+            LR_CHECK(readDateTime.getHour() == 13);
+            LR_CHECK(readDateTime.getMinute() == 45);
+            LR_CHECK(readDateTime.getSecond() == 30);
+        } else if (alarmMode == DS3231::AlarmMode::DateHoursMinutesSeconds) {
+            LR_CHECK(readDateTime.getDay() == 17);
+            LR_CHECK(readDateTime.getHour() == 13);
+        } else if (alarmMode == DS3231::AlarmMode::DayHoursMinutesSeconds) {
+            LR_CHECK(readDateTime.getDayOfWeek() == dateTime.getDayOfWeek());
+            LR_CHECK(readDateTime.getDay() == 1);
+        }
+    }
+    // Alarm 2 has no seconds.
+    LR_CHECK(rtc.setAlarm2(DS3231::AlarmMode::HoursMinutesSeconds, dateTime) == DS3231::Status::Success);
+    LR_CHECK(chip.getRegister(0x0b) == 0x45);
+    LR_CHECK(chip.getRegister(0x0c) == 0x13);
+    DS3231::AlarmMode readMode;
+    DateTime readDateTime;
+    LR_CHECK(rtc.getAlarm2(readMode, readDateTime) == DS3231::Status::Success);
+    LR_CHECK(readMode == DS3231::AlarmMode::HoursMinutesSeconds);
+    LR_CHECK(readDateTime.getMinute() == 45);
+    LR_CHECK(readDateTime.getSecond() == 0);
+}
+
+
+void testAlarmIfChanged()
+{
+    MockDS3231 chip;
+    prepareRunningChip(chip);
+    DS3231 rtc(&chip);
+    rtc.setCacheEnabled(true);
+    LR_CHECK(rtc.syncCache() == DS3231::Status::Success);
+    const DateTime dateTime(2024, 5, 17, 13, 45, 30);
+    LR_CHECK(rtc.setAlarmIfChanged(DS3231::Alarm::Alarm1, DS3231::AlarmMode::MinutesSeconds, dateTime)
+        == DS3231::Status::Success);
+    LR_CHECK(chip.getRegister(0x07) == 0x30);
+    chip.resetCounters();
+    LR_CHECK(rtc.setAlarmIfChanged(DS3231::Alarm::Alarm1, DS3231::AlarmMode::MinutesSeconds, dateTime)
+        == DS3231::Status::Success);
+    LR_CHECK(chip.getCounters().reads == 0);
+    LR_CHECK(chip.getCounters().writes == 0);
+}
+
+
+void testReadAndClearAlarms()
+{
+    MockDS3231 chip;
+    prepareRunningChip(chip);
+    DS3231 rtc(&chip);
+    chip.setRegister(0x0f, 0x0a); // EN32kHz and A2F.
+    bool isAlarm1Set;
+    bool isAlarm2Set;
+    LR_CHECK(rtc.readAndClearAlarms(isAlarm1Set, isAlarm2Set) == DS3231::Status::Success);
+    LR_CHECK(!isAlarm1Set);
+    LR_CHECK(isAlarm2Set);
+    LR_CHECK(chip.getRegister(0x0f) == 0x08);
+    chip.resetCounters();
+    LR_CHECK(rtc.readAndClearAlarms(isAlarm1Set, isAlarm2Set) == DS3231::Status::Success);
+    LR_CHECK(!isAlarm1Set && !isAlarm2Set);
+    LR_CHECK(chip.getCounters().writes == 0);
+}
+
+
+void testBeginWritesDifference()
+{
+    MockDS3231 chip;
+    prepareRunningChip(chip);
+    DS3231 rtc(&chip);
+    const DS3231::Config config{
+        DS3231::getPowerProfile(DS3231::PowerPreset::DeepSleepWakeOnAlarm),
+        DS3231::AlarmMode::HoursMinutesSeconds, DateTime(2024, 1, 1, 6, 30, 0),
+        DS3231::AlarmMode::OncePerSecond, DateTime()};
+    bool isTimeValid;
+    chip.resetCounters();
+    LR_CHECK(rtc.begin(config, isTimeValid) == DS3231::Status::Success);
+    LR_CHECK(isTimeValid);
+    LR_CHECK(chip.getCounters().reads == 1);
+    LR_CHECK(chip.getCounters().writes == 1);
+    LR_CHECK(chip.getRegister(0x08) == 0x30);
+    LR_CHECK(chip.getRegister(0x09) == 0x06);
+    // The second call finds an identical configuration and writes nothing.
+    chip.resetCounters();
+    LR_CHECK(rtc.begin(config, isTimeValid) == DS3231::Status::Success);
+    LR_CHECK(chip.getCounters().reads == 1);
+    LR_CHECK(chip.getCounters().writes == 0);
+    // A single changed register is written alone: 2 bytes of address and register, plus the value.
+    auto changedConfig = config;
+    changedConfig.alarm1 = DateTime(2024, 1, 1, 6, 31, 0);
+    chip.resetCounters();
+    LR_CHECK(rtc.begin(changedConfig, isTimeValid) == DS3231::Status::Success);
+    LR_CHECK(chip.getCounters().writes == 1);
+    LR_CHECK(chip.getCounters().bytes == (3 + 9) + (2 + 1));
+    LR_CHECK(chip.getRegister(0x08) == 0x31);
+}
+
+
+void testBeginKeepsOscillatorFlag()
+{
+    MockDS3231 chip; // The power-on state, with the OSF flag set.
+    DS3231 rtc(&chip);
+    const DS3231::Config config{
+        DS3231::getPowerProfile(DS3231::PowerPreset::FullyOff),
+        DS3231::AlarmMode::OncePerSecond, DateTime(),
+        DS3231::AlarmMode::OncePerSecond, DateTime()};
+    bool isTimeValid;
+    LR_CHECK(rtc.begin(config, isTimeValid) == DS3231::Status::Success);
+    LR_CHECK(!isTimeValid);
+    LR_CHECK((chip.getRegister(0x0f) & 0x80) != 0);
+    LR_CHECK((chip.getRegister(0x0f) & 0x08) == 0);
+}
+
+
+void testIncrementalReadRollover()
+{
+    MockDS3231 chip;
+    prepareRunningChip(chip);
+    DS3231 rtc(&chip);
+    rtc.setIncrementalReadEnabled(&getMilliseconds);
+    gMilliseconds = 1000;
+    setChipTime(chip, 24, 12, 31, 23, 59, 58);
+    uint32_t unixTime;
+    LR_CHECK(rtc.getUnixTime(unixTime) == DS3231::Status::Success);
+    LR_CHECK(unixTime == 1735689598);
+    // Within the minute, only the seconds register is read.
+    chip.resetCounters();
+    gMilliseconds += 1000;
+    chip.setRegister(0x00, 0x59);
+    LR_CHECK(rtc.getUnixTime(unixTime) == DS3231::Status::Success);
+    LR_CHECK(unixTime == 1735689599);
+    LR_CHECK(chip.getCounters().bytes == 3 + 1);
+    // The rollover of the seconds triggers a full read, which sees the new year.
+    chip.resetCounters();
+    gMilliseconds += 1000;
+    setChipTime(chip, 25, 1, 1, 0, 0, 0);
+    DateTime dateTime;
+    LR_CHECK(rtc.getDateTime(dateTime) == DS3231::Status::Success);
+    LR_CHECK(dateTime == DateTime(2025, 1, 1, 0, 0, 0));
+    LR_CHECK(chip.getCounters().reads == 2);
+    LR_CHECK(rtc.getUnixTime(unixTime) == DS3231::Status::Success);
+    LR_CHECK(unixTime == 1735689600);
+    // After the read window, a full read is done, even if the seconds did not roll over.
+    chip.resetCounters();
+    gMilliseconds += DS3231::cIncrementalReadWindow;
+    setChipTime(chip, 25, 1, 1, 0, 1, 30);
+    LR_CHECK(rtc.getUnixTime(unixTime) == DS3231::Status::Success);
+    LR_CHECK(unixTime == 1735689690);
+    LR_CHECK(chip.getCounters().reads == 1);
+    LR_CHECK(chip.getCounters().bytes == 3 + 7);
+}
+
+
+void testRetryWithFailures()
+{
+    MockDS3231 chip;
+    prepareRunningChip(chip);
+    DS3231 rtc(&chip);
+    const DateTime dateTime(2024, 6, 1, 12, 0, 0);
+    LR_CHECK(rtc.setDateTime(dateTime) == DS3231::Status::Success);
+    // Without a retry policy, the first failure is reported.
+    chip.setFailureCount(1);
+    DateTime readDateTime;
+    LR_CHECK(rtc.getDateTime(readDateTime) == DS3231::Status::Error);
+    // With three attempts, two failures are recovered.
+    DS3231::RetryPolicy policy;
+    policy.maximumAttempts = 3;
+    rtc.setRetryPolicy(policy);
+    chip.resetCounters();
+    chip.setFailureCount(2);
+    LR_CHECK(rtc.getDateTime(readDateTime) == DS3231::Status::Success);
+    LR_CHECK(readDateTime == dateTime);
+    LR_CHECK(chip.getCounters().failures == 2);
+    LR_CHECK(chip.getCounters().reads == 3);
+    // Writes are retried the same way.
+    chip.setFailureCount(2);
+    LR_CHECK(rtc.setAlarm1(DS3231::AlarmMode::SecondsMatch, dateTime) == DS3231::Status::Success);
+    // More failures than attempts are reported.
+    chip.resetCounters();
+    chip.setFailureCount(3);
+    LR_CHECK(rtc.getDateTime(readDateTime) == DS3231::Status::Error);
+    LR_CHECK(chip.getCounters().failures == 3);
+    LR_CHECK(rtc.getDateTime(readDateTime) == DS3231::Status::Success);
+}
+
+
+void testBatchRanges()
+{
+    MockDS3231 chip;
+    prepareRunningChip(chip);
+    DS3231 rtc(&chip);
+    const DateTime dateTime(2024, 6, 1, 12, 0, 0);
+    // The date/time and alarm 1 are in sequence, and written in one transfer.
+    DS3231::Batch batch(&rtc);
+    LR_CHECK(batch.isEmpty());
+    LR_CHECK(batch.setDateTime(dateTime) == DS3231::Status::Success);
+    batch.setAlarm1(DS3231::AlarmMode::SecondsMatch, DateTime(2024, 6, 1, 12, 0, 15));
+    LR_CHECK(!batch.isEmpty());
+    chip.resetCounters();
+    LR_CHECK(batch.commit() == DS3231::Status::Success);
+    LR_CHECK(batch.isEmpty());
+    LR_CHECK(chip.getCounters().writes == 1);
+    LR_CHECK(chip.getCounters().bytes == 2 + 11);
+    LR_CHECK(chip.getRegister(0x07) == 0x15);
+    // The date/time and alarm 2 are separated by alarm 1, so two transfers are used.
+    LR_CHECK(batch.setDateTime(dateTime) == DS3231::Status::Success);
+    batch.setAlarm2(DS3231::AlarmMode::MinutesSeconds, DateTime(2024, 6, 1, 12, 30, 0));
+    chip.resetCounters();
+    LR_CHECK(batch.commit() == DS3231::Status::Success);
+    LR_CHECK(chip.getCounters().writes == 2);
+    LR_CHECK(chip.getCounters().bytes == (2 + 7) + (2 + 3));
+    LR_CHECK(chip.getRegister(0x0b) == 0x30);
+    // A cleared batch writes nothing.
+    batch.setAlarm2(DS3231::AlarmMode::MinutesSeconds, DateTime(2024, 6, 1, 12, 45, 0));
+    batch.clear();
+    chip.resetCounters();
+    LR_CHECK(batch.commit() == DS3231::Status::Success);
+    LR_CHECK(chip.getCounters().writes == 0);
+    LR_CHECK(chip.getRegister(0x0b) == 0x30);
+}
+
+
+void testRegisterRangeRules()
+{
+    MockDS3231 chip;
+    prepareRunningChip(chip);
+    DS3231 rtc(&chip);
+    bool isRunning;
+    LR_CHECK(rtc.isRunning(isRunning) == DS3231::Status::Success);
+    LR_CHECK(isRunning);
+    chip.setRegister(0x0f, 0x88);
+    LR_CHECK(rtc.isRunning(isRunning) == DS3231::Status::Success);
+    LR_CHECK(!isRunning);
+    LR_CHECK(rtc.enableOscillator() == DS3231::Status::Success);
+    LR_CHECK(chip.getRegister(0x0f) == 0x08);
+    LR_CHECK(rtc.isRunning(isRunning) == DS3231::Status::Success);
+    LR_CHECK(isRunning);
+}
+
+
+}
+
+
+int main()
+{
+    LR_RUN_TEST(testDateTimeRoundTrip);
+    LR_RUN_TEST(testUnixTimeRange);
+    LR_RUN_TEST(testAlarmRoundTrip);
+    LR_RUN_TEST(testAlarmIfChanged);
+    LR_RUN_TEST(testReadAndClearAlarms);
+    LR_RUN_TEST(testBeginWritesDifference);
+    LR_RUN_TEST(testBeginKeepsOscillatorFlag);
+    LR_RUN_TEST(testIncrementalReadRollover);
+    LR_RUN_TEST(testRetryWithFailures);
+    LR_RUN_TEST(testBatchRanges);
+    LR_RUN_TEST(testRegisterRangeRules);
+    return TestCheck::result();
+}
+
@@ -0,0 +1,131 @@
+//
+// The tests of the DS3231PulseCounter class
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DS3231PulseCounter.hpp"
+#include "TestCheck.hpp"
+
+
+using namespace lr;
+
+
+namespace {
+
+
+/// The simulated 16 bit hardware timer, with its overflow flag.
+///
+uint16_t gCounter = 0;
+bool gIsOverflowPending = false;
+
+uint16_t readCounter()
+{
+    return gCounter;
+}
+
+bool isOverflowPending()
+{
+    return gIsOverflowPending;
+}
+
+uint16_t readOtherCounter()
+{
+    return gCounter;
+}
+
+
+using PulseCounter = DS3231PulseCounter<&readCounter, &isOverflowPending>;
+using PlainPulseCounter = DS3231PulseCounter<&readOtherCounter>;
+
+
+/// Let the timer wrap around, without running the overflow interrupt.
+///
+void wrapCounter(uint16_t newValue)
+{
+    gCounter = newValue;
+    gIsOverflowPending = true;
+}
+
+
+/// Run the overflow interrupt.
+///
+void runOverflowInterrupt()
+{
+    gIsOverflowPending = false;
+    PulseCounter::onOverflow();
+    PlainPulseCounter::onOverflow();
+}
+
+
+void testExtendedTicks()
+{
+    static_assert(PulseCounter::cTicksPerSecond == 32768, "The counter runs at 32kHz.");
+    gCounter = 0x1234;
+    const uint32_t startTicks = PulseCounter::getTicks();
+    LR_CHECK(static_cast<uint16_t>(startTicks) == 0x1234);
+    gCounter = 0xfff0;
+    LR_CHECK(PulseCounter::getTicks() - startTicks == 0xfff0u - 0x1234u);
+    wrapCounter(0x0010);
+    runOverflowInterrupt();
+    LR_CHECK(PulseCounter::getTicks() - startTicks == 0x10010u - 0x1234u);
+    LR_CHECK(PlainPulseCounter::getTicks() == PulseCounter::getTicks());
+}
+
+
+void testPendingOverflow()
+{
+    gCounter = 0xfffe;
+    const uint32_t before = PulseCounter::getTicks();
+    // The counter wrapped, but the interrupt is blocked.
+    wrapCounter(0x0002);
+    const uint32_t pending = PulseCounter::getTicks();
+    LR_CHECK(pending - before == 4);
+    // Without the flag, the value jumps back by one period.
+    LR_CHECK(PlainPulseCounter::getTicks() - before == 4u - 0x10000u);
+    // After the interrupt ran, the value is the same.
+    runOverflowInterrupt();
+    LR_CHECK(PulseCounter::getTicks() == pending);
+    LR_CHECK(PlainPulseCounter::getTicks() == pending);
+    // A flag set after the read of a large value does not count twice.
+    gCounter = 0xffff;
+    gIsOverflowPending = true;
+    LR_CHECK(PulseCounter::getTicks() - before == 0x10001u);
+    gIsOverflowPending = false;
+}
+
+
+void testExtendCapture()
+{
+    gCounter = 0x4000;
+    const uint32_t ticks = PulseCounter::getTicks();
+    LR_CHECK(PulseCounter::extendCapture(0x3000) == ticks - 0x1000u);
+    // A value captured before the last overflow.
+    LR_CHECK(PulseCounter::extendCapture(0xf000) == ticks - 0x5000u);
+}
+
+
+}
+
+
+int main()
+{
+    LR_RUN_TEST(testExtendedTicks);
+    LR_RUN_TEST(testPendingOverflow);
+    LR_RUN_TEST(testExtendCapture);
+    return TestCheck::result();
+}
+
@@ -0,0 +1,199 @@
+//
+// The tests of the DS3231Scheduler class
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DS3231Scheduler.hpp"
+#include "MockDS3231.hpp"
+#include "TestCheck.hpp"
+
+
+using namespace lr;
+
+
+namespace {
+
+
+/// 2024-01-01 00:00:00
+///
+const uint32_t cStartTime = 1704067200;
+
+
+/// The calls of the handlers, in order.
+///
+char gCalls[16];
+uint8_t gCallCount = 0;
+
+void record(char name)
+{
+    if (gCallCount < sizeof(gCalls)) {
+        gCalls[gCallCount++] = name;
+    }
+}
+
+void handlerA() { record('a'); }
+void handlerB() { record('b'); }
+void handlerC() { record('c'); }
+void handlerD() { record('d'); }
+
+bool isCalled(const char *calls)
+{
+    uint8_t index = 0;
+    for (; calls[index] != '\0'; ++index) {
+        if (index >= gCallCount || gCalls[index] != calls[index]) {
+            return false;
+        }
+    }
+    return index == gCallCount;
+}
+
+
+/// A chip with a scheduler.
+///
+struct Fixture {
+    Fixture() : chip(), rtc(&chip), entries(), scheduler(&rtc, entries, 4) {
+        gCallCount = 0;
+        chip.setRegister(0x0f, 0x08); // A running chip, with the OSF flag cleared.
+        rtc.setUnixTime(cStartTime);
+        rtc.setPowerProfile(DS3231::PowerPreset::DeepSleepWakeOnAlarm);
+    }
+
+    void setTime(uint32_t unixTime) {
+        rtc.setUnixTime(unixTime);
+    }
+
+    bool isAlarm1InterruptEnabled() const {
+        return (chip.getRegister(0x0e) & 0x01) != 0;
+    }
+
+    MockDS3231 chip;
+    DS3231 rtc;
+    DS3231Scheduler::Entry entries[4];
+    DS3231Scheduler scheduler;
+};
+
+
+void testHeapOrder()
+{
+    Fixture f;
+    LR_CHECK(f.scheduler.scheduleAt(cStartTime + 30, &handlerA) == DS3231Scheduler::Status::Success);
+    LR_CHECK(f.scheduler.scheduleAt(cStartTime + 10, &handlerB) == DS3231Scheduler::Status::Success);
+    LR_CHECK(f.scheduler.scheduleAt(cStartTime + 20, &handlerC) == DS3231Scheduler::Status::Success);
+    LR_CHECK(f.scheduler.scheduleAt(cStartTime + 5, &handlerD) == DS3231Scheduler::Status::Success);
+    LR_CHECK(f.scheduler.getCount() == 4);
+    // The storage is full.
+    LR_CHECK(f.scheduler.scheduleAt(cStartTime + 1, &handlerA) == DS3231Scheduler::Status::Error);
+    uint32_t deadline;
+    LR_CHECK(f.scheduler.getNextDeadline(deadline));
+    LR_CHECK(deadline == cStartTime + 5);
+    // Alarm 1 is programmed with the nearest deadline.
+    LR_CHECK(f.chip.getRegister(0x07) == 0x05);
+    // All timers are called in the order of their deadlines.
+    f.setTime(cStartTime + 30);
+    LR_CHECK(f.scheduler.process() == DS3231Scheduler::Status::Success);
+    LR_CHECK(isCalled("dbca"));
+    LR_CHECK(f.scheduler.getCount() == 0);
+    LR_CHECK(!f.scheduler.getNextDeadline(deadline));
+    LR_CHECK(!f.isAlarm1InterruptEnabled());
+}
+
+
+void testProcessBeforeDeadline()
+{
+    Fixture f;
+    LR_CHECK(f.scheduler.scheduleAt(cStartTime + 10, &handlerA) == DS3231Scheduler::Status::Success);
+    LR_CHECK(f.scheduler.scheduleAt(cStartTime + 20, &handlerB) == DS3231Scheduler::Status::Success);
+    f.setTime(cStartTime + 15);
+    LR_CHECK(f.scheduler.process() == DS3231Scheduler::Status::Success);
+    LR_CHECK(isCalled("a"));
+    // The alarm is programmed again, with the next deadline.
+    LR_CHECK(f.chip.getRegister(0x07) == 0x20);
+    f.setTime(cStartTime + 19);
+    LR_CHECK(f.scheduler.process() == DS3231Scheduler::Status::Success);
+    LR_CHECK(isCalled("a"));
+    LR_CHECK(f.scheduler.getCount() == 1);
+}
+
+
+void testRepeatingTimer()
+{
+    Fixture f;
+    LR_CHECK(f.scheduler.scheduleAt(cStartTime + 10, &handlerA, 10) == DS3231Scheduler::Status::Success);
+    f.setTime(cStartTime + 10);
+    LR_CHECK(f.scheduler.process() == DS3231Scheduler::Status::Success);
+    LR_CHECK(isCalled("a"));
+    uint32_t deadline;
+    LR_CHECK(f.scheduler.getNextDeadline(deadline));
+    LR_CHECK(deadline == cStartTime + 20);
+    LR_CHECK(f.chip.getRegister(0x07) == 0x20);
+    // Missed calls are skipped.
+    f.setTime(cStartTime + 55);
+    LR_CHECK(f.scheduler.process() == DS3231Scheduler::Status::Success);
+    LR_CHECK(isCalled("aa"));
+    LR_CHECK(f.scheduler.getNextDeadline(deadline));
+    LR_CHECK(deadline == cStartTime + 65);
+    LR_CHECK(f.isAlarm1InterruptEnabled());
+}
+
+
+void testCancelAndRearm()
+{
+    Fixture f;
+    LR_CHECK(f.scheduler.scheduleAt(cStartTime + 10, &handlerA) == DS3231Scheduler::Status::Success);
+    LR_CHECK(f.scheduler.scheduleAt(cStartTime + 40, &handlerB) == DS3231Scheduler::Status::Success);
+    LR_CHECK(f.scheduler.scheduleAt(cStartTime + 50, &handlerA) == DS3231Scheduler::Status::Success);
+    LR_CHECK(f.scheduler.cancel(&handlerA) == DS3231Scheduler::Status::Success);
+    LR_CHECK(f.scheduler.getCount() == 1);
+    LR_CHECK(f.chip.getRegister(0x07) == 0x40);
+    // Without timers, the interrupt is disabled, and enabled again with the next timer.
+    LR_CHECK(f.scheduler.cancel(&handlerB) == DS3231Scheduler::Status::Success);
+    LR_CHECK(!f.isAlarm1InterruptEnabled());
+    LR_CHECK(f.scheduler.scheduleAt(cStartTime + 3, &handlerC) == DS3231Scheduler::Status::Success);
+    LR_CHECK(f.isAlarm1InterruptEnabled());
+    LR_CHECK(f.chip.getRegister(0x07) == 0x03);
+}
+
+
+void testFarDeadline()
+{
+    Fixture f;
+    const uint32_t farDeadline = cStartTime + 40 * 86400;
+    LR_CHECK(f.scheduler.scheduleAt(farDeadline, &handlerA) == DS3231Scheduler::Status::Success);
+    // The intermediate alarm does not call the handler.
+    f.setTime(cStartTime + DS3231::cMaximumWakeDelay);
+    LR_CHECK(f.scheduler.process() == DS3231Scheduler::Status::Success);
+    LR_CHECK(isCalled(""));
+    LR_CHECK(f.scheduler.getCount() == 1);
+    f.setTime(farDeadline);
+    LR_CHECK(f.scheduler.process() == DS3231Scheduler::Status::Success);
+    LR_CHECK(isCalled("a"));
+}
+
+
+}
+
+
+int main()
+{
+    LR_RUN_TEST(testHeapOrder);
+    LR_RUN_TEST(testProcessBeforeDeadline);
+    LR_RUN_TEST(testRepeatingTimer);
+    LR_RUN_TEST(testCancelAndRearm);
+    LR_RUN_TEST(testFarDeadline);
+    return TestCheck::result();
+}
+
@@ -0,0 +1,71 @@
+#pragma once
+//
+// Minimal checks for the host tests
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstdio>
+
+
+namespace lr {
+namespace TestCheck {
+
+
+/// Get the number of failed checks.
+///
+inline int& failureCount() {
+    static int count = 0;
+    return count;
+}
+
+/// Report a failed check.
+///
+inline void fail(const char *expression, const char *file, int line) {
+    std::printf("%s:%d: check failed: %s\n", file, line, expression);
+    ++failureCount();
+}
+
+/// Run one test function and print its name.
+///
+inline void run(const char *name, void (*test)()) {
+    const int failuresBefore = failureCount();
+    test();
+    std::printf("%s %s\n", failureCount() == failuresBefore ? "pass" : "FAIL", name);
+}
+
+/// Get the exit code of the test program.
+///
+inline int result() {
+    return failureCount() == 0 ? 0 : 1;
+}
+
+
+}
+}
+
+
+/// Check a condition and continue with the test if it fails.
+///
+#define LR_CHECK(condition) \
+    do { if (!(condition)) { ::lr::TestCheck::fail(#condition, __FILE__, __LINE__); } } while (false)
+
+/// Run a test function.
+///
+#define LR_RUN_TEST(test) ::lr::TestCheck::run(#test, &test)
+
@@ -0,0 +1,147 @@
+//
+// The tests of the DS3231 time records
+// ---------------------------------------------------------------------------
+// (c)2018 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "DS3231.hpp"
+#include "DS3231TimeRecord.hpp"
+#include "MockDS3231.hpp"
+#include "TestCheck.hpp"
+
+
+using namespace lr;
+
+
+namespace {
+
+
+void testPackedValues()
+{
+    DS3231TimeRecord record;
+    LR_CHECK(DS3231TimeRecord::fromValues(24, 12, 31, 23, 59, 58, 0, record));
+    LR_CHECK(record.getYearOffset() == 24);
+    LR_CHECK(record.getMonth() == 12);
+    LR_CHECK(record.getDay() == 31);
+    LR_CHECK(record.getHour() == 23);
+    LR_CHECK(record.getMinute() == 59);
+    LR_CHECK(record.getSecond() == 58);
+    LR_CHECK(record.getMillisecond() == 0);
+    // The whole record is big endian, with the year in the top bits.
+    uint8_t bytes[DS3231TimeRecord::cSize];
+    record.getBytes(bytes);
+    LR_CHECK((bytes[0] >> 2) == 24);
+    LR_CHECK(DS3231TimeRecord::fromBytes(bytes) == record);
+    // Values out of range are rejected.
+    LR_CHECK(!DS3231TimeRecord::fromValues(64, 1, 1, 0, 0, 0, 0, record));
+    LR_CHECK(!DS3231TimeRecord::fromValues(0, 13, 1, 0, 0, 0, 0, record));
+    LR_CHECK(!DS3231TimeRecord::fromValues(0, 1, 0, 0, 0, 0, 0, record));
+    LR_CHECK(!DS3231TimeRecord::fromValues(0, 1, 1, 24, 0, 0, 0, record));
+}
+
+
+void testMillisecondRecord()
+{
+    DS3231TimeRecordMs record;
+    LR_CHECK(DS3231TimeRecordMs::fromValues(255, 2, 28, 12, 0, 1, 999, record));
+    LR_CHECK(record.getYearOffset() == 255);
+    LR_CHECK(record.getSecond() == 1);
+    LR_CHECK(record.getMillisecond() == 999);
+    LR_CHECK(!DS3231TimeRecordMs::fromValues(256, 1, 1, 0, 0, 0, 0, record));
+    LR_CHECK(!DS3231TimeRecordMs::fromValues(0, 1, 1, 0, 0, 0, 1000, record));
+    const DateTime dateTime(2100, 3, 4, 5, 6, 7);
+    LR_CHECK(DS3231TimeRecordMs::fromDateTime(dateTime, 2000, 500, record));
+    LR_CHECK(record.toDateTime(2000) == dateTime);
+    LR_CHECK(record.getMillisecond() == 500);
+}
+
+
+void testOrder()
+{
+    const DateTime dateTimes[] = {
+        DateTime(2001, 1, 1, 0, 0, 0),
+        DateTime(2001, 1, 1, 0, 0, 1),
+        DateTime(2001, 1, 1, 0, 1, 0),
+        DateTime(2001, 2, 1, 0, 0, 0),
+        DateTime(2030, 1, 1, 0, 0, 0),
+    };
+    const uint32_t count = sizeof(dateTimes) / sizeof(dateTimes[0]);
+    for (uint32_t i = 1; i < count; ++i) {
+        DS3231TimeRecord earlier;
+        DS3231TimeRecord later;
+        LR_CHECK(DS3231TimeRecord::fromDateTime(dateTimes[i - 1], 2000, 0, earlier));
+        LR_CHECK(DS3231TimeRecord::fromDateTime(dateTimes[i], 2000, 0, later));
+        LR_CHECK(earlier < later);
+        LR_CHECK(later > earlier);
+        LR_CHECK(earlier != later);
+        LR_CHECK(earlier.compare(earlier) == 0);
+    }
+    // Records before the year base are rejected.
+    DS3231TimeRecord record;
+    LR_CHECK(!DS3231TimeRecord::fromDateTime(DateTime(1999, 12, 31, 0, 0, 0), 2000, 0, record));
+}
+
+
+void testBufferRoundTrip()
+{
+    const DateTime dateTimes[] = {
+        DateTime(2024, 1, 1, 0, 0, 0),
+        DateTime(2024, 6, 15, 12, 30, 45),
+        DateTime(2063, 12, 31, 23, 59, 59),
+    };
+    uint8_t data[3 * DS3231TimeRecord::cSize];
+    LR_CHECK(DS3231TimeRecord::encode(dateTimes, 3, 2000, data));
+    DateTime decoded[3];
+    DS3231TimeRecord::decode(data, 3, 2000, decoded);
+    for (uint8_t i = 0; i < 3; ++i) {
+        LR_CHECK(decoded[i] == dateTimes[i]);
+    }
+    // A value outside of the range is stored as zero bytes.
+    const DateTime outOfRange[] = {DateTime(2064, 1, 1, 0, 0, 0)};
+    LR_CHECK(!DS3231TimeRecord::encode(outOfRange, 1, 2000, data));
+    LR_CHECK(data[0] == 0 && data[1] == 0 && data[2] == 0 && data[3] == 0);
+}
+
+
+void testReadFromChip()
+{
+    MockDS3231 chip;
+    chip.setRegister(0x0f, 0x08); // A running chip, with the OSF flag cleared.
+    DS3231 rtc(&chip);
+    const DateTime dateTime(2024, 7, 8, 9, 10, 11);
+    LR_CHECK(rtc.setDateTime(dateTime) == DS3231::Status::Success);
+    DS3231TimeRecord record;
+    LR_CHECK(rtc.getTimeRecord(record) == DS3231::Status::Success);
+    LR_CHECK(record.toDateTime(rtc.getYearBase()) == dateTime);
+    // The offset from the year base is outside of the 4 byte record.
+    LR_CHECK(rtc.setDateTime(DateTime(2064, 1, 1, 0, 0, 0)) == DS3231::Status::Success);
+    LR_CHECK(rtc.getTimeRecord(record) == DS3231::Status::Error);
+}
+
+
+}
+
+
+int main()
+{
+    LR_RUN_TEST(testPackedValues);
+    LR_RUN_TEST(testMillisecondRecord);
+    LR_RUN_TEST(testOrder);
+    LR_RUN_TEST(testBufferRoundTrip);
+    LR_RUN_TEST(testReadFromChip);
+    return TestCheck::result();
+}
+